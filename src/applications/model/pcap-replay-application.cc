@@ -0,0 +1,297 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay-application.h"
+#include "ns3/log.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/trace-source-accessor.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplayApplication");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplayApplication);
+
+namespace {
+// the data link types of the libpcap documentation
+const uint32_t DLT_NULL = 0;
+const uint32_t DLT_EN10MB = 1;
+const uint32_t DLT_PPP = 9;
+const uint32_t DLT_RAW = 101;
+const uint32_t DLT_LINUX_SLL = 113;
+const uint32_t DLT_IPV4 = 228;
+
+const uint16_t ETHERTYPE_IPV4 = 0x0800;
+const uint16_t ETHERTYPE_VLAN = 0x8100;
+const uint16_t PPP_IPV4 = 0x0021;
+
+uint16_t
+ReadNtohU16 (const uint8_t *data)
+{
+  return (data[0] << 8) | data[1];
+}
+} // anonymous namespace
+
+TypeId
+PcapReplayApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplayApplication")
+    .SetParent<Application> ()
+    .AddConstructor<PcapReplayApplication> ()
+    .AddAttribute ("FileName",
+                   "The name of the pcap file to replay.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplayApplication::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxPackets",
+                   "The number of packets to send. "
+                   "The value zero means that the whole file is sent.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapReplayApplication::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Tx", "A packet of the file is sent",
+                     MakeTraceSourceAccessor (&PcapReplayApplication::m_txTrace))
+  ;
+  return tid;
+}
+
+PcapReplayApplication::PcapReplayApplication ()
+  : m_maxPackets (0),
+    m_socket (0),
+    m_sent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplayApplication::~PcapReplayApplication ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+PcapReplayApplication::GetSent (void) const
+{
+  return m_sent;
+}
+
+void
+PcapReplayApplication::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_file.Close ();
+  // chain up
+  Application::DoDispose ();
+}
+
+void
+PcapReplayApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Open (m_filename);
+  if (m_file.Fail ())
+    {
+      NS_FATAL_ERROR ("Could not read pcap file " << m_filename);
+    }
+  uint32_t type = m_file.GetDataLinkType ();
+  if (type != DLT_NULL && type != DLT_EN10MB && type != DLT_PPP
+      && type != DLT_RAW && type != DLT_LINUX_SLL && type != DLT_IPV4)
+    {
+      NS_FATAL_ERROR ("Unsupported data link type " << type << " in " << m_filename);
+    }
+  if (m_socket == 0)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), TypeId::LookupByName ("ns3::Ipv4RawSocketFactory"));
+      m_socket->SetAttribute ("IpHeaderInclude", BooleanValue (true));
+      m_socket->Bind ();
+      m_socket->ShutdownRecv ();
+    }
+  m_startTime = Simulator::Now ();
+  m_firstTimestamp = Seconds (-1);
+  ScheduleNext ();
+}
+
+void
+PcapReplayApplication::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  m_file.Close ();
+}
+
+Time
+PcapReplayApplication::GetTimestamp (const PcapMappedFile::Record &record) const
+{
+  int64_t ns = record.tsSec * 1000000000LL;
+  if (m_file.IsNanoSeconds ())
+    {
+      ns += record.tsUsec;
+    }
+  else
+    {
+      ns += record.tsUsec * 1000LL;
+    }
+  return NanoSeconds (ns);
+}
+
+bool
+PcapReplayApplication::GetNetworkOffset (const PcapMappedFile::Record &record, uint32_t &offset) const
+{
+  const uint8_t *data = record.data;
+  uint32_t length = record.inclLen;
+  switch (m_file.GetDataLinkType ())
+    {
+    case DLT_NULL:
+      // the address family, in the byte order of the writer
+      if (length < 4 || (data[0] != 2 && data[3] != 2))
+        {
+          return false;
+        }
+      offset = 4;
+      break;
+    case DLT_EN10MB:
+      if (length >= 14 && ReadNtohU16 (data + 12) == ETHERTYPE_IPV4)
+        {
+          offset = 14;
+        }
+      else if (length >= 18 && ReadNtohU16 (data + 12) == ETHERTYPE_VLAN
+               && ReadNtohU16 (data + 16) == ETHERTYPE_IPV4)
+        {
+          offset = 18;
+        }
+      else
+        {
+          return false;
+        }
+      break;
+    case DLT_PPP:
+      if (length >= 2 && ReadNtohU16 (data) == PPP_IPV4)
+        {
+          offset = 2;
+        }
+      else if (length >= 4 && data[0] == 0xff && data[1] == 0x03
+               && ReadNtohU16 (data + 2) == PPP_IPV4)
+        {
+          offset = 4;
+        }
+      else
+        {
+          return false;
+        }
+      break;
+    case DLT_LINUX_SLL:
+      if (length < 16 || ReadNtohU16 (data + 14) != ETHERTYPE_IPV4)
+        {
+          return false;
+        }
+      offset = 16;
+      break;
+    default:
+      offset = 0;
+      break;
+    }
+  // a complete IPv4 header must have been captured
+  if (length < offset + 20 || (data[offset] >> 4) != 4
+      || length < offset + (data[offset] & 0xf) * 4U)
+    {
+      return false;
+    }
+  return true;
+}
+
+Ptr<Packet>
+PcapReplayApplication::GetPacket (const PcapMappedFile::Record &record) const
+{
+  uint32_t offset;
+  if (!GetNetworkOffset (record, offset))
+    {
+      return 0;
+    }
+  uint32_t captured = record.inclLen - offset;
+  uint32_t size = ReadNtohU16 (record.data + offset + 2);
+  if (size < (record.data[offset] & 0xf) * 4U)
+    {
+      return 0;
+    }
+  // link layers may pad short frames
+  Ptr<Packet> packet = Create<Packet> (record.data + offset, std::min (captured, size));
+  if (captured < size)
+    {
+      packet->AddPaddingAtEnd (size - captured);
+    }
+  return packet;
+}
+
+void
+PcapReplayApplication::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_maxPackets != 0 && m_sent >= m_maxPackets)
+    {
+      return;
+    }
+  PcapMappedFile::Record record;
+  while (m_file.Next (record))
+    {
+      Ptr<Packet> packet = GetPacket (record);
+      if (packet == 0)
+        {
+          NS_LOG_LOGIC ("Skip record which is not an IPv4 packet");
+          continue;
+        }
+      Time timestamp = GetTimestamp (record);
+      if (m_firstTimestamp.IsStrictlyNegative ())
+        {
+          m_firstTimestamp = timestamp;
+        }
+      Time delay = m_startTime + (timestamp - m_firstTimestamp) - Simulator::Now ();
+      if (delay.IsStrictlyNegative ())
+        {
+          // the timestamps of a capture may go backwards slightly
+          delay = Seconds (0);
+        }
+      m_sendEvent = Simulator::Schedule (delay, &PcapReplayApplication::Send, this, packet);
+      return;
+    }
+  if (m_file.Fail ())
+    {
+      NS_LOG_WARN ("Stopped replaying " << m_filename << " on a truncated record");
+    }
+}
+
+void
+PcapReplayApplication::Send (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  m_txTrace (packet);
+  // the destination is taken from the header of the packet
+  if (m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address::GetAny (), 0)) < 0)
+    {
+      NS_LOG_LOGIC ("Could not send packet " << packet->GetUid ());
+    }
+  m_sent++;
+  ScheduleNext ();
+}
+
+} // namespace ns3
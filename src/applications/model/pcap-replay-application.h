@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_APPLICATION_H
+#define PCAP_REPLAY_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/pcap-mapped-file.h"
+#include <string>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup applications
+ * \defgroup pcapreplay PcapReplayApplication
+ *
+ * This traffic generator sends the IPv4 packets of a pcap file, headers
+ * included, from its node.  The packets are sent at the times recorded
+ * in the file, relative to the first one which is sent when the
+ * application starts.  They are routed according to their destination
+ * address, whatever their source address.
+ *
+ * The file is read one record ahead of the simulation, through a memory
+ * mapping, so that traces of any size can be replayed.  Raw IPv4,
+ * Ethernet, PPP, BSD loopback and Linux cooked captures are supported:
+ * the packets which are not IPv4 are skipped.  Packets truncated by the
+ * capture are padded back to their original size.
+ */
+class PcapReplayApplication : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  PcapReplayApplication ();
+  virtual ~PcapReplayApplication ();
+
+  /**
+   * \return the number of packets sent so far
+   */
+  uint32_t GetSent (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  // inherited from Application base class.
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \param record a record of the file
+   * \return the IPv4 packet of the record, or zero if it has none.
+   */
+  Ptr<Packet> GetPacket (const PcapMappedFile::Record &record) const;
+  /**
+   * \param offset [out] where the network header starts
+   * \return false if the frame does not hold an IPv4 packet.
+   */
+  bool GetNetworkOffset (const PcapMappedFile::Record &record, uint32_t &offset) const;
+  Time GetTimestamp (const PcapMappedFile::Record &record) const;
+  void ScheduleNext (void);
+  void Send (Ptr<Packet> packet);
+
+  std::string m_filename;
+  uint32_t m_maxPackets;
+  PcapMappedFile m_file;
+  Ptr<Socket> m_socket;
+  EventId m_sendEvent;
+  uint32_t m_sent;
+  // where the first record of the file is replayed
+  Time m_firstTimestamp;
+  Time m_startTime;
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_APPLICATION_H */
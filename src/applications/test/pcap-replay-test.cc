@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/pcap-replay-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Replay an Ethernet capture of UDP packets, sent from an address which
+ * does not exist in the simulation, to a packet sink.
+ */
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void WriteFrame (PcapFile &file, Time t, uint16_t etherType, Ptr<Packet> p);
+  void Receive (Ptr<const Packet> p, const Address &from);
+
+  std::vector<Time> m_times;
+  std::vector<uint32_t> m_sizes;
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Check that the IPv4 packets of a pcap file are sent at their recorded times")
+{
+}
+
+void
+PcapReplayTestCase::WriteFrame (PcapFile &file, Time t, uint16_t etherType, Ptr<Packet> p)
+{
+  std::vector<uint8_t> frame (14 + p->GetSize (), 0);
+  frame[12] = etherType >> 8;
+  frame[13] = etherType & 0xff;
+  p->CopyData (&frame[14], p->GetSize ());
+  uint64_t us = t.GetMicroSeconds ();
+  file.Write (us / 1000000, us % 1000000, &frame[0], frame.size ());
+}
+
+void
+PcapReplayTestCase::Receive (Ptr<const Packet> p, const Address &from)
+{
+  m_times.push_back (Simulator::Now ());
+  m_sizes.push_back (p->GetSize ());
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  // the packets are truncated by the capture and an ARP frame is skipped
+  std::string filename = CreateTempDirFilename ("replay.pcap");
+  PcapFile file;
+  file.Open (filename, std::ios::out);
+  file.Init (1, 64);
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + i * 100);
+      UdpHeader udp;
+      udp.SetSourcePort (1234);
+      udp.SetDestinationPort (4000);
+      p->AddHeader (udp);
+      Ipv4Header ip;
+      ip.SetSource (Ipv4Address ("192.168.0.1"));
+      ip.SetDestination (Ipv4Address ("10.1.1.2"));
+      ip.SetProtocol (17);
+      ip.SetTtl (64);
+      ip.SetPayloadSize (p->GetSize ());
+      p->AddHeader (ip);
+      WriteFrame (file, Seconds (100 + 0.5 * i), 0x0800, p);
+      if (i == 1)
+        {
+          WriteFrame (file, Seconds (100.6), 0x0806, Create<Packet> (28));
+        }
+    }
+  file.Close ();
+
+  NodeContainer n;
+  n.Create (2);
+  InternetStackHelper internet;
+  internet.Install (n);
+  Ptr<SimpleNetDevice> txDev = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (txDev);
+  d.Add (rxDev);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (d);
+
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 4000));
+  ApplicationContainer sinks = sinkHelper.Install (n.Get (1));
+  sinks.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&PcapReplayTestCase::Receive, this));
+
+  PcapReplayHelper replay (filename);
+  ApplicationContainer apps = replay.Install (n.Get (0));
+  apps.Start (Seconds (1.0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 4, "Every IPv4 packet should have been received");
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], Seconds (1 + 0.5 * i), "Packet " << i << " was not sent at its time");
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], 100 + i * 100, "Packet " << i << " should have its original size");
+    }
+}
+
+class PcapReplayTestSuite : public TestSuite
+{
+public:
+  PcapReplayTestSuite ();
+};
+
+PcapReplayTestSuite::PcapReplayTestSuite ()
+  : TestSuite ("pcap-replay", UNIT)
+{
+  AddTestCase (new PcapReplayTestCase);
+}
+
+static PcapReplayTestSuite pcapReplayTestSuite;
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-writer.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <string.h>
+
+/*
+ * Each record is a uint32_t size, padded to HEADER_SIZE, followed by its
+ * data and padded to 8 bytes.  A record never wraps around the end of
+ * the ring: the space left there is skipped, and marked by a SKIP size.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("AsyncWriter");
+
+namespace ns3 {
+
+namespace {
+const uint32_t HEADER_SIZE = 8;
+const uint32_t SKIP = 0xffffffff;
+} // anonymous namespace
+
+AsyncWriter::AsyncWriter (uint32_t size, Callback<void, const uint8_t *, uint32_t> consumer)
+  : m_ring (size),
+    m_consumer (consumer),
+    m_written (0),
+    m_read (0),
+    m_reserved (0)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size % 8 == 0);
+  GetWriters ()->push_back (this);
+#ifdef HAVE_PTHREAD_H
+  Start ();
+#endif
+}
+
+AsyncWriter::~AsyncWriter ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      Stop ();
+    }
+#else
+  Drain ();
+#endif
+  std::vector<AsyncWriter *> *writers = GetWriters ();
+  writers->erase (std::find (writers->begin (), writers->end (), this));
+}
+
+std::vector<AsyncWriter *> *
+AsyncWriter::GetWriters (void)
+{
+  // never deleted since writers may be destroyed by static destructors
+  static std::vector<AsyncWriter *> *writers = new std::vector<AsyncWriter *> ();
+  return writers;
+}
+
+uint32_t
+AsyncWriter::GetRecordSize (uint32_t size)
+{
+  return (HEADER_SIZE + size + 7) & ~7U;
+}
+
+uint64_t
+AsyncWriter::Consume (uint64_t read, uint64_t written)
+{
+  while (read != written)
+    {
+      uint32_t start = read % m_ring.size ();
+      uint32_t size;
+      memcpy (&size, &m_ring[start], sizeof (size));
+      if (size == SKIP)
+        {
+          read += m_ring.size () - start;
+          continue;
+        }
+      m_consumer (&m_ring[start + HEADER_SIZE], size);
+      read += GetRecordSize (size);
+    }
+  return read;
+}
+
+uint8_t *
+AsyncWriter::Reserve (uint32_t size)
+{
+  uint32_t ringSize = m_ring.size ();
+  uint32_t recordSize = GetRecordSize (size);
+  if (recordSize > ringSize / 2)
+    {
+      // the space for it would never be available
+      NS_FATAL_ERROR ("Record of " << size << " bytes is too large for a ring of " << ringSize << " bytes");
+    }
+#ifdef HAVE_PTHREAD_H
+  m_producer.Lock ();
+#endif
+  uint32_t start = m_written % ringSize;
+  uint32_t skipped = 0;
+  if (ringSize - start < recordSize)
+    {
+      skipped = ringSize - start;
+    }
+#ifdef HAVE_PTHREAD_H
+  for (;;)
+    {
+      // clear before checking so that progress made in between is not missed
+      m_spaceReady.SetCondition (false);
+      uint64_t used;
+      {
+        CriticalSection cs (m_mutex);
+        used = m_written - m_read;
+      }
+      if (skipped + recordSize <= ringSize - used)
+        {
+          break;
+        }
+      m_dataReady.SetCondition (true);
+      m_dataReady.Signal ();
+      m_spaceReady.TimedWait (1000000);
+    }
+#else
+  if (skipped + recordSize > ringSize - (m_written - m_read))
+    {
+      m_read = Consume (m_read, m_written);
+    }
+#endif
+  if (skipped != 0)
+    {
+      memcpy (&m_ring[start], &SKIP, sizeof (SKIP));
+      start = 0;
+    }
+  memcpy (&m_ring[start], &size, sizeof (size));
+  m_reserved = skipped + recordSize;
+  return &m_ring[start + HEADER_SIZE];
+}
+
+void
+AsyncWriter::Commit (void)
+{
+#ifdef HAVE_PTHREAD_H
+  uint32_t reserved = m_reserved;
+  uint64_t used;
+  {
+    CriticalSection cs (m_mutex);
+    m_written += reserved;
+    used = m_written - m_read;
+  }
+  m_producer.Unlock ();
+  // the writer sleeps once the ring is empty, and is otherwise only
+  // hurried when the ring fills up
+  if (used == reserved || used > m_ring.size () / 4)
+    {
+      m_dataReady.SetCondition (true);
+      m_dataReady.Signal ();
+    }
+#else
+  m_written += m_reserved;
+#endif
+}
+
+void
+AsyncWriter::Write (const void *buffer, uint32_t size)
+{
+  memcpy (Reserve (size), buffer, size);
+  Commit ();
+}
+
+void
+AsyncWriter::Drain (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  for (;;)
+    {
+      m_spaceReady.SetCondition (false);
+      bool empty;
+      {
+        CriticalSection cs (m_mutex);
+        empty = m_written == m_read;
+      }
+      if (empty)
+        {
+          break;
+        }
+      m_dataReady.SetCondition (true);
+      m_dataReady.Signal ();
+      m_spaceReady.TimedWait (1000000);
+    }
+#else
+  m_read = Consume (m_read, m_written);
+#endif
+}
+
+void
+AsyncWriter::SuspendAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::vector<AsyncWriter *> *writers = GetWriters ();
+  for (std::vector<AsyncWriter *>::iterator i = writers->begin (); i != writers->end (); ++i)
+    {
+#ifdef HAVE_PTHREAD_H
+      if ((*i)->m_thread != 0)
+        {
+          (*i)->Stop ();
+        }
+#else
+      (*i)->Drain ();
+#endif
+    }
+}
+
+void
+AsyncWriter::ResumeAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+#ifdef HAVE_PTHREAD_H
+  std::vector<AsyncWriter *> *writers = GetWriters ();
+  for (std::vector<AsyncWriter *>::iterator i = writers->begin (); i != writers->end (); ++i)
+    {
+      if ((*i)->m_thread == 0)
+        {
+          (*i)->Start ();
+        }
+    }
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+AsyncWriter::Start (void)
+{
+  m_stop = false;
+  m_thread = Create<SystemThread> (MakeCallback (&AsyncWriter::Run, this));
+  m_thread->Start ();
+}
+
+void
+AsyncWriter::Stop (void)
+{
+  // the writer consumes all the records before it stops
+  {
+    CriticalSection cs (m_mutex);
+    m_stop = true;
+  }
+  m_dataReady.SetCondition (true);
+  m_dataReady.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+}
+
+void
+AsyncWriter::Run (void)
+{
+  for (;;)
+    {
+      m_dataReady.SetCondition (false);
+      uint64_t written;
+      uint64_t read;
+      bool stop;
+      {
+        CriticalSection cs (m_mutex);
+        written = m_written;
+        read = m_read;
+        stop = m_stop;
+      }
+      if (written == read)
+        {
+          if (stop)
+            {
+              break;
+            }
+          // woken up by Commit, Drain or Stop
+          m_dataReady.Wait ();
+          continue;
+        }
+      read = Consume (read, written);
+      {
+        CriticalSection cs (m_mutex);
+        m_read = read;
+      }
+      m_spaceReady.SetCondition (true);
+      m_spaceReady.Signal ();
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
+} // namespace ns3
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include "callback.h"
+#include "ptr.h"
+#include "ns3/core-config.h"
+#include <stdint.h>
+#include <vector>
+
+#ifdef HAVE_PTHREAD_H
+#include "system-thread.h"
+#include "system-mutex.h"
+#include "system-condition.h"
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief Hand records over to a thread which writes them out
+ *
+ * The producers reserve room for each record in a byte ring, fill it and
+ * commit it: a writer thread then passes the records, in order, to the
+ * consumer callback which usually writes them to a file.  The mutex only
+ * protects the two counters of the ring, each side copies its bytes
+ * outside of it.  The producers are serialized by a second mutex since
+ * several simulation threads may write records.
+ *
+ * Without pthreads, the producer calls the consumer itself when the ring
+ * fills up, when it is drained and when the writer is destroyed.
+ */
+class AsyncWriter
+{
+public:
+  /**
+   * \param size the size of the ring, in bytes
+   * \param consumer called, from the writer thread, with the data and
+   *        size of each record
+   */
+  AsyncWriter (uint32_t size, Callback<void, const uint8_t *, uint32_t> consumer);
+  /**
+   * Consume the records left and stop the writer thread.
+   */
+  ~AsyncWriter ();
+
+  /**
+   * \param size the size of the record, at most half of the ring
+   * \returns where the record should be copied before Commit is called.
+   *
+   * This blocks until there is enough room in the ring.
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * Hand over the record returned by the last call to Reserve.
+   */
+  void Commit (void);
+  /**
+   * \param buffer the record
+   * \param size the size of the record
+   *
+   * Reserve, copy and commit a record.
+   */
+  void Write (const void *buffer, uint32_t size);
+  /**
+   * Wait until all the records committed were consumed.
+   */
+  void Drain (void);
+
+  /**
+   * Drain all the writers and stop their threads, which would not exist
+   * in the child of a fork(2).
+   */
+  static void SuspendAll (void);
+  /**
+   * Start the threads stopped by SuspendAll again.
+   */
+  static void ResumeAll (void);
+
+private:
+  AsyncWriter (const AsyncWriter &o);
+  AsyncWriter &operator = (const AsyncWriter &o);
+
+  static std::vector<AsyncWriter *> *GetWriters (void);
+  static uint32_t GetRecordSize (uint32_t size);
+  /**
+   * \param read where to start
+   * \param written where to stop
+   * \returns where the next record starts
+   */
+  uint64_t Consume (uint64_t read, uint64_t written);
+#ifdef HAVE_PTHREAD_H
+  void Start (void);
+  void Stop (void);
+  void Run (void);
+#endif
+
+  std::vector<uint8_t> m_ring;
+  Callback<void, const uint8_t *, uint32_t> m_consumer;
+  // total bytes appended to and removed from the ring
+  uint64_t m_written;
+  uint64_t m_read;
+  // bytes used by the record being reserved, including skipped space
+  uint32_t m_reserved;
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_producer;
+  SystemMutex m_mutex;
+  SystemCondition m_dataReady;
+  SystemCondition m_spaceReady;
+  Ptr<SystemThread> m_thread;
+  bool m_stop;
+#endif
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_WRITER_H */
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "simulator.h"
+#include "log.h"
+#include "fatal-error.h"
+#include "async-writer.h"
+#include "simulator-impl.h"
+#include "ns3/core-config.h"
+
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <stdio.h>
+
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace ns3 {
+
+namespace {
+
+bool g_isParent = false;
+uint32_t g_variant = 0;
+uint32_t g_failed = 0;
+
+std::map<const void *, std::string> *
+GetOutputs (void)
+{
+  // never deleted since files may be closed by static destructors
+  static std::map<const void *, std::string> *outputs = new std::map<const void *, std::string> ();
+  return outputs;
+}
+
+#ifdef HAVE_SYS_WAIT_H
+/**
+ * Wait for any child to exit and account for its status.
+ */
+void
+WaitOne (void)
+{
+  int status;
+  pid_t pid;
+  do
+    {
+      pid = waitpid (-1, &status, 0);
+    }
+  while (pid < 0 && errno == EINTR);
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("waitpid failed: " << strerror (errno));
+    }
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("Variant process " << pid << " failed");
+      g_failed++;
+    }
+}
+#endif
+
+void
+CheckImplementation (void)
+{
+  // their threads and their peer processes would not follow the fork
+  std::string name = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  if (name == "ns3::RealtimeSimulatorImpl" || name == "ns3::DistributedSimulatorImpl")
+    {
+      NS_FATAL_ERROR ("Checkpoints cannot be used with " << name);
+    }
+}
+
+void
+Fork (uint32_t variants, Callback<void, uint32_t> setup, uint32_t maxRunning)
+{
+#ifdef HAVE_SYS_WAIT_H
+  NS_LOG_FUNCTION (variants << maxRunning);
+  CheckImplementation ();
+  std::map<const void *, std::string> *outputs = GetOutputs ();
+  if (!outputs->empty ())
+    {
+      std::ostringstream oss;
+      for (std::map<const void *, std::string>::const_iterator i = outputs->begin (); i != outputs->end (); ++i)
+        {
+          oss << " " << i->second;
+        }
+      NS_FATAL_ERROR ("Every variant would write to the files open at the checkpoint:" << oss.str ());
+    }
+  // buffered output would otherwise be written once by every child
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+  // the writer threads would not exist in the children
+  AsyncWriter::SuspendAll ();
+
+  uint32_t running = 0;
+  for (uint32_t i = 0; i < variants; ++i)
+    {
+      if (maxRunning != 0 && running == maxRunning)
+        {
+          WaitOne ();
+          running--;
+        }
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("fork failed: " << strerror (errno));
+        }
+      if (pid == 0)
+        {
+          AsyncWriter::ResumeAll ();
+          g_variant = i;
+          NS_LOG_LOGIC ("Variant " << i << " starts at " << Simulator::Now ().GetSeconds () << "s");
+          setup (i);
+          return;
+        }
+      running++;
+    }
+  AsyncWriter::ResumeAll ();
+  while (running > 0)
+    {
+      WaitOne ();
+      running--;
+    }
+  g_isParent = true;
+  Simulator::Stop ();
+#else
+  NS_FATAL_ERROR ("Checkpoints need fork(2), which is not available on this system");
+#endif
+}
+
+} // anonymous namespace
+
+void
+Checkpoint::Schedule (Time at, uint32_t variants, Callback<void, uint32_t> setup,
+                      uint32_t maxRunning)
+{
+  NS_LOG_FUNCTION (at << variants << maxRunning);
+  CheckImplementation ();
+  Simulator::Schedule (at - Simulator::Now (), &Fork, variants, setup, maxRunning);
+}
+
+bool
+Checkpoint::IsVariant (void)
+{
+  return !g_isParent;
+}
+
+uint32_t
+Checkpoint::GetVariant (void)
+{
+  return g_variant;
+}
+
+uint32_t
+Checkpoint::GetFailedCount (void)
+{
+  return g_failed;
+}
+
+void
+Checkpoint::RegisterOutput (const void *owner, std::string filename)
+{
+  NS_LOG_FUNCTION (owner << filename);
+  (*GetOutputs ())[owner] = filename;
+}
+
+void
+Checkpoint::UnregisterOutput (const void *owner)
+{
+  NS_LOG_FUNCTION (owner);
+  GetOutputs ()->erase (owner);
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "nstime.h"
+#include "callback.h"
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief Share the warm-up of a simulation between several variants
+ *
+ * At the checkpoint time, the process is forked once per variant.  Each
+ * child starts from an exact copy of the simulation state (scheduled
+ * events, nodes, sockets, queues, random number stream positions), calls
+ * the setup callback with its variant index so that it can apply its own
+ * attributes with Config::Set, and runs to the end.  The parent waits for
+ * all of its children and then stops its own simulation: Simulator::Run
+ * returns right after the checkpoint, and IsVariant tells the code which
+ * follows Simulator::Run whether it should write any results.
+ *
+ * \code
+ * Checkpoint::Schedule (Seconds (100), 4, MakeCallback (&ApplyVariant));
+ * Simulator::Run ();
+ * if (Checkpoint::IsVariant ())
+ *   {
+ *     WriteResults (Checkpoint::GetVariant ());
+ *   }
+ * Simulator::Destroy ();
+ * \endcode
+ *
+ * The copy is a copy-on-write snapshot of the address space made by
+ * fork(2): it is only available on posix systems, and it cannot be used
+ * with the distributed or realtime simulators whose state also lives
+ * in other processes or threads, which is a fatal error.  The threads of the asynchronous pcap
+ * and binary log writers are stopped before the fork and started again
+ * in every process.  The files open at the checkpoint would be shared
+ * by all the variants: reaching a checkpoint while pcap, ascii or binary
+ * traces or a binary log are being written is a fatal error.  Enable
+ * them in the setup callback instead, with a name specific to the
+ * variant.
+ */
+class Checkpoint
+{
+public:
+  /**
+   * \param at the simulation time of the checkpoint
+   * \param variants the number of variants to fork
+   * \param setup called in each child with the index of its variant
+   * \param maxRunning the largest number of children alive at the same
+   *        time, or zero for no limit
+   */
+  static void Schedule (Time at, uint32_t variants, Callback<void, uint32_t> setup,
+                        uint32_t maxRunning = 0);
+  /**
+   * \return true in the children forked at a checkpoint, and in a
+   *         simulation which did not reach one yet.
+   */
+  static bool IsVariant (void);
+  /**
+   * \return the index of this variant, or zero if no checkpoint was
+   *         reached
+   */
+  static uint32_t GetVariant (void);
+  /**
+   * \return the number of children which did not exit with a zero status,
+   *         as seen by the parent
+   */
+  static uint32_t GetFailedCount (void);
+
+  /**
+   * \param owner the object which writes the file
+   * \param filename the name of the file
+   *
+   * Called by the classes which write files, such as the trace files,
+   * while their file is open.
+   */
+  static void RegisterOutput (const void *owner, std::string filename);
+  /**
+   * \param owner the object which wrote a file
+   *
+   * Nothing happens if owner has no file registered.
+   */
+  static void UnregisterOutput (const void *owner);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -27,6 +27,8 @@
 #include "log.h"
 
 #include <sstream>
+#include <map>
+#include <set>
 
 NS_LOG_COMPONENT_DEFINE ("Config");
 
@@ -133,79 +135,119 @@ class ArrayMatcher
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
+  /**
+   * \param max the largest number of indexes to return
+   * \param indexes the indexes matched, sorted, if they are at most max
+   * \returns false if more than max indexes, or all of them, match
+   */
+  bool GetIndexes (uint32_t max, std::set<uint32_t> *indexes) const;
 private:
+  void Parse (std::string element);
   bool StringToUint32 (std::string str, uint32_t *value) const;
   std::string m_element;
+  // the element is parsed once into a wildcard flag and a list of
+  // inclusive ranges so that matching a large container is cheap
+  bool m_all;
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  if (m_element == "*")
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Parse (element.substr (0, tmp-0));
+      Parse (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
 
+bool
+ArrayMatcher::GetIndexes (uint32_t max, std::set<uint32_t> *indexes) const
+{
+  if (m_all)
+    {
+      return false;
+    }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (j->first > j->second)
+        {
+          continue;
+        }
+      if ((uint64_t)j->second - j->first >= max)
+        {
+          return false;
+        }
+      for (uint64_t i = j->first; i <= j->second; ++i)
+        {
+          indexes->insert (i);
+        }
+      if (indexes->size () > max)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -224,20 +266,39 @@ public:
 
   void Resolve (Ptr<Object> root);
 private:
+  // an attribute through which a path can go down to other objects
+  struct PathAttribute
+  {
+    std::string name;
+    bool isPointer; // otherwise an object container
+    Ptr<const ObjectPtrContainerAccessor> container;
+  };
+  static const std::vector<PathAttribute> &GetPathAttributes (TypeId tid);
+  static TypeId LookupTypeId (std::string name);
+
   void Canonicalize (void);
-  void DoResolve (std::string path, Ptr<Object> root);
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolve (uint32_t segment, Ptr<Object> root);
+  void DoArrayResolve (uint32_t segment, Ptr<Object> root, const PathAttribute &attribute);
   void DoResolveOne (Ptr<Object> object);
   std::string GetResolvedPath (void) const;
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
   std::vector<std::string> m_workStack;
   std::string m_path;
+  // the path split once on '/'
+  std::vector<std::string> m_segments;
 };
 
 Resolver::Resolver (std::string path)
   : m_path (path)
 {
   Canonicalize ();
+  std::string::size_type cur = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", cur)) != std::string::npos)
+    {
+      m_segments.push_back (m_path.substr (cur, next - cur));
+      cur = next + 1;
+    }
 }
 Resolver::~Resolver ()
 {
@@ -260,10 +321,59 @@ Resolver::Canonicalize (void)
     }
 }
 
+const std::vector<Resolver::PathAttribute> &
+Resolver::GetPathAttributes (TypeId tid)
+{
+  // The attributes of a TypeId are all registered before its first
+  // instance is created, so the pointer and container attributes of each
+  // TypeId are sorted out once instead of for each object of every path.
+  static std::map<uint16_t, std::vector<PathAttribute> > cache;
+  std::map<uint16_t, std::vector<PathAttribute> >::iterator i = cache.find (tid.GetUid ());
+  if (i != cache.end ())
+    {
+      return i->second;
+    }
+  std::vector<PathAttribute> &attributes = cache[tid.GetUid ()];
+  for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+    {
+      struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+      PathAttribute attribute;
+      attribute.name = info.name;
+      if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+        {
+          attribute.isPointer = true;
+          attributes.push_back (attribute);
+        }
+      else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+        {
+          attribute.isPointer = false;
+          attribute.container = DynamicCast<const ObjectPtrContainerAccessor> (info.accessor);
+          attributes.push_back (attribute);
+        }
+      // this could be anything else and we don't know what to do with it.
+      // So, we just ignore it.
+    }
+  return attributes;
+}
+
+TypeId
+Resolver::LookupTypeId (std::string name)
+{
+  static std::map<std::string, TypeId> cache;
+  std::map<std::string, TypeId>::iterator i = cache.find (name);
+  if (i != cache.end ())
+    {
+      return i->second;
+    }
+  TypeId tid = TypeId::LookupByName (name);
+  cache[name] = tid;
+  return tid;
+}
+
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -285,13 +395,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t segment, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (segment << root);
 
-  if (next == std::string::npos)
+  if (segment == m_segments.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -307,8 +415,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const std::string &item = m_segments[segment];
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -319,11 +426,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (segment + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -340,7 +446,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (segment + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -362,7 +468,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = LookupTypeId (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
@@ -370,29 +476,25 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (segment + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid = root->GetInstanceTypeId ();
+      const std::vector<PathAttribute> &attributes = GetPathAttributes (root->GetInstanceTypeId ());
       bool foundMatch = false;
-      for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+      for (std::vector<PathAttribute>::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
         {
-          struct TypeId::AttributeInformation info;
-          info = tid.GetAttribute(i);
-          if (info.name != item && item != "*")
+          if (i->name != item && item != "*")
             {
               continue;
             }
-          // attempt to cast to a pointer checker.
-          const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-          if (ptr != 0)
+          if (i->isPointer)
             {
-              NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
               PointerValue ptr;
-              root->GetAttribute (info.name, ptr);
+              root->GetAttribute (i->name, ptr);
               Ptr<Object> object = ptr.Get<Object> ();
               if (object == 0)
                 {
@@ -402,25 +504,18 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
                   continue;
                 }
               foundMatch = true;
-              m_workStack.push_back (info.name);
-              DoResolve (pathLeft, object);
+              m_workStack.push_back (i->name);
+              DoResolve (segment + 1, object);
               m_workStack.pop_back ();
             }
-          // attempt to cast to an object vector.
-          const ObjectPtrContainerChecker *vectorChecker = 
-            dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-          if (vectorChecker != 0)
+          else
             {
-              NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
               foundMatch = true;
-              ObjectPtrContainerValue vector;
-              root->GetAttribute (info.name, vector);
-              m_workStack.push_back (info.name);
-              DoArrayResolve (pathLeft, vector);
+              m_workStack.push_back (i->name);
+              DoArrayResolve (segment + 1, root, *i);
               m_workStack.pop_back ();
             }
-          // this could be anything else and we don't know what to do with it.
-          // So, we just ignore it.
         }
       if (!foundMatch)
         {
@@ -431,20 +526,40 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t segment, Ptr<Object> root, const PathAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << segment);
+  if (segment == m_segments.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  ArrayMatcher matcher = ArrayMatcher (m_segments[segment]);
+  // look up a few indexes directly rather than copy a large container
+  uint32_t n;
+  std::set<uint32_t> indexes;
+  if (attribute.container != 0 &&
+      attribute.container->GetN (PeekPointer (root), &n) &&
+      matcher.GetIndexes (n, &indexes))
+    {
+      for (std::set<uint32_t>::const_iterator i = indexes.begin (); i != indexes.end (); ++i)
+        {
+          Ptr<Object> object = attribute.container->GetByIndex (PeekPointer (root), *i);
+          if (object == 0)
+            {
+              continue;
+            }
+          std::ostringstream oss;
+          oss << *i;
+          m_workStack.push_back (oss.str ());
+          DoResolve (segment + 1, object);
+          m_workStack.pop_back ();
+        }
+      return;
+    }
+
+  ObjectPtrContainerValue container;
+  root->GetAttribute (attribute.name, container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -453,7 +568,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (segment + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -689,6 +804,62 @@ Config::MatchContainer LookupMatches (std::string path)
   return Singleton<ConfigImpl>::Get ()->LookupMatches (path);
 }
 
+void
+Batch::Add (enum Kind kind, std::string path, Ptr<const AttributeValue> value, const CallbackBase &cb)
+{
+  Operation operation;
+  operation.kind = kind;
+  operation.path = path;
+  operation.value = value;
+  operation.cb = cb;
+  m_operations.push_back (operation);
+}
+void
+Batch::Set (std::string path, const AttributeValue &value)
+{
+  Add (SET, path, value.Copy (), CallbackBase ());
+}
+void
+Batch::Connect (std::string path, const CallbackBase &cb)
+{
+  Add (CONNECT, path, 0, cb);
+}
+void
+Batch::ConnectWithoutContext (std::string path, const CallbackBase &cb)
+{
+  Add (CONNECT_WITHOUT_CONTEXT, path, 0, cb);
+}
+void
+Batch::Apply (void)
+{
+  std::map<std::string, MatchContainer> matches;
+  for (std::vector<Operation>::const_iterator i = m_operations.begin (); i != m_operations.end (); ++i)
+    {
+      std::string::size_type slash = i->path.find_last_of ("/");
+      NS_ASSERT (slash != std::string::npos);
+      std::string root = i->path.substr (0, slash);
+      std::string leaf = i->path.substr (slash + 1, i->path.size () - (slash + 1));
+      std::map<std::string, MatchContainer>::iterator match = matches.find (root);
+      if (match == matches.end ())
+        {
+          match = matches.insert (std::make_pair (root, LookupMatches (root))).first;
+        }
+      switch (i->kind)
+        {
+        case SET:
+          match->second.Set (leaf, *i->value);
+          break;
+        case CONNECT:
+          match->second.Connect (leaf, i->cb);
+          break;
+        case CONNECT_WITHOUT_CONTEXT:
+          match->second.ConnectWithoutContext (leaf, i->cb);
+          break;
+        }
+    }
+  m_operations.clear ();
+}
+
 void RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   Singleton<ConfigImpl>::Get ()->RegisterRootNamespaceObject (obj);
@@ -21,14 +21,14 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "attribute.h"
+#include "callback.h"
 #include <string>
 #include <vector>
 
 namespace ns3 {
 
-class AttributeValue;
 class Object;
-class CallbackBase;
 
 /**
  * \brief Configuration of simulation parameters and tracing
@@ -222,6 +222,64 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \brief a list of Set and Connect operations applied together
+ *
+ * Each operation has the same effect as the Config function of the same
+ * name, but the objects matched by the path of an operation, less its last
+ * segment, are looked up once per Apply however many operations share
+ * them.  This makes connecting several trace sources of the same objects,
+ * for example the Enqueue, Dequeue and Drop sources of
+ * "/NodeList/x/DeviceList/x/TxQueue", much cheaper in large topologies.
+ *
+ * The objects matched by a path are looked up when the first operation
+ * which uses it is applied: an operation which changes the objects a
+ * later operation goes through should be applied on its own.
+ */
+class Batch
+{
+public:
+  /**
+   * \param path a path to match attributes.
+   * \param value the value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (std::string path, const AttributeValue &value);
+  /**
+   * \param path a path to match trace sources.
+   * \param cb the callback to connect to the matching trace sources.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (std::string path, const CallbackBase &cb);
+  /**
+   * \param path a path to match trace sources.
+   * \param cb the callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (std::string path, const CallbackBase &cb);
+  /**
+   * Perform the operations added so far, in order, and forget them.
+   */
+  void Apply (void);
+
+private:
+  enum Kind
+  {
+    SET,
+    CONNECT,
+    CONNECT_WITHOUT_CONTEXT
+  };
+  struct Operation
+  {
+    enum Kind kind;
+    std::string path;
+    Ptr<const AttributeValue> value;
+    CallbackBase cb;
+  };
+  void Add (enum Kind kind, std::string path, Ptr<const AttributeValue> value, const CallbackBase &cb);
+  std::vector<Operation> m_operations;
+};
+
 /**
  * \param obj a new root object
  *
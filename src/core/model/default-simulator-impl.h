@@ -24,15 +24,25 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 namespace ns3 {
 
+/**
+ * \ingroup core
+ *
+ * The default single-threaded simulator.  When the EnableProfiling
+ * attribute is set, the number of events and the wall-clock time spent
+ * in them are recorded per event type and per context, and a report
+ * sorted by cumulative time is printed by Simulator::Destroy.
+ */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
 public:
@@ -60,6 +70,12 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \return the per-event-type profile, only filled when the
+   *         EnableProfiling attribute is set
+   */
+  const EventProfiler & GetProfiler (void) const;
+
 private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
@@ -89,6 +105,10 @@ private:
   int m_unscheduledEvents;
 
   SystemThread::ThreadId m_main;
+
+  bool m_profiling;
+  std::string m_profilingOutput;
+  EventProfiler m_profiler;
 };
 
 } // namespace ns3
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "ns3/core-config.h"
+
+#include <typeinfo>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+namespace ns3 {
+
+namespace {
+
+typedef std::pair<uint64_t, std::pair<uint64_t, std::string> > Row;
+
+bool
+CompareRows (const Row &a, const Row &b)
+{
+  return a.first > b.first;
+}
+
+void
+PrintRows (std::ostream &os, std::vector<Row> rows, uint64_t totalNs)
+{
+  std::sort (rows.begin (), rows.end (), CompareRows);
+  os << std::setw (12) << "time(s)" << std::setw (8) << "%"
+     << std::setw (12) << "count" << std::setw (10) << "avg(ns)" << "  name" << std::endl;
+  for (std::vector<Row>::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      uint64_t ns = i->first;
+      uint64_t count = i->second.first;
+      os << std::setw (12) << std::fixed << std::setprecision (6) << ns / 1e9
+         << std::setw (8) << std::setprecision (2) << (totalNs ? 100.0 * ns / totalNs : 0.0)
+         << std::setw (12) << count
+         << std::setw (10) << (count ? ns / count : 0)
+         << "  " << i->second.second << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+EventProfiler::EventProfiler ()
+  : m_start (0)
+{
+}
+
+uint64_t
+EventProfiler::GetNanoSeconds (void)
+{
+#ifdef HAVE_RT
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+std::string
+EventProfiler::Demangle (const char *mangled)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0 && demangled != 0)
+    {
+      std::string ret = demangled;
+      free (demangled);
+      return ret;
+    }
+  free (demangled);
+#endif
+  return mangled;
+}
+
+void
+EventProfiler::Start (void)
+{
+  m_start = GetNanoSeconds ();
+}
+
+void
+EventProfiler::Stop (const EventImpl *event, uint32_t context, bool cancelled)
+{
+  uint64_t ns = GetNanoSeconds () - m_start;
+  Stats *stats;
+  if (cancelled)
+    {
+      stats = &m_cancelled;
+    }
+  else
+    {
+      stats = &m_types[typeid (*event).name ()];
+    }
+  stats->count++;
+  stats->ns += ns;
+  Stats &perContext = m_contexts[context];
+  perContext.count++;
+  perContext.ns += ns;
+  m_total.count++;
+  m_total.ns += ns;
+}
+
+uint64_t
+EventProfiler::GetEventCount (void) const
+{
+  return m_total.count;
+}
+
+uint64_t
+EventProfiler::GetEventCount (uint32_t context) const
+{
+  std::map<uint32_t, Stats>::const_iterator i = m_contexts.find (context);
+  if (i == m_contexts.end ())
+    {
+      return 0;
+    }
+  return i->second.count;
+}
+
+uint64_t
+EventProfiler::GetCancelledCount (void) const
+{
+  return m_cancelled.count;
+}
+
+void
+EventProfiler::Report (std::ostream &os) const
+{
+  // the same type may show up under several type_info names when it was
+  // instantiated in several libraries; merge them by demangled name
+  std::map<std::string, Stats> types;
+  for (std::map<const char *, Stats>::const_iterator i = m_types.begin (); i != m_types.end (); ++i)
+    {
+      Stats &stats = types[Demangle (i->first)];
+      stats.count += i->second.count;
+      stats.ns += i->second.ns;
+    }
+  std::vector<Row> rows;
+  for (std::map<std::string, Stats>::const_iterator i = types.begin (); i != types.end (); ++i)
+    {
+      rows.push_back (Row (i->second.ns, std::make_pair (i->second.count, i->first)));
+    }
+  if (m_cancelled.count != 0)
+    {
+      rows.push_back (Row (m_cancelled.ns, std::make_pair (m_cancelled.count, std::string ("(cancelled)"))));
+    }
+
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+
+  os << "Event profile: " << m_total.count << " events in "
+     << std::fixed << std::setprecision (6) << m_total.ns / 1e9 << "s" << std::endl;
+  os << "By event type:" << std::endl;
+  PrintRows (os, rows, m_total.ns);
+
+  rows.clear ();
+  for (std::map<uint32_t, Stats>::const_iterator i = m_contexts.begin (); i != m_contexts.end (); ++i)
+    {
+      std::ostringstream name;
+      if (i->first == 0xffffffff)
+        {
+          name << "no context";
+        }
+      else
+        {
+          name << "node " << i->first;
+        }
+      rows.push_back (Row (i->second.ns, std::make_pair (i->second.count, name.str ())));
+    }
+  os << "By context:" << std::endl;
+  PrintRows (os, rows, m_total.ns);
+
+  os.flags (flags);
+  os.precision (precision);
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <ostream>
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup core
+ * \brief Attribute event counts and wall-clock time to event types
+ *
+ * The simulator calls Start before it invokes an event and Stop right
+ * after.  The time spent is accumulated per concrete EventImpl type (which
+ * names the class and member function signature of the scheduled callback),
+ * and per context (node id).  Cancelled events are counted on their own
+ * since they cost a scheduler removal but no work.
+ */
+class EventProfiler
+{
+public:
+  EventProfiler ();
+
+  /**
+   * Record the wall-clock time at which the next event starts
+   */
+  void Start (void);
+  /**
+   * \param event the event which was just invoked
+   * \param context the context in which it ran
+   * \param cancelled whether the event had been cancelled
+   */
+  void Stop (const EventImpl *event, uint32_t context, bool cancelled);
+
+  /**
+   * \return the number of events recorded
+   */
+  uint64_t GetEventCount (void) const;
+  /**
+   * \param context a context (node id)
+   * \return the number of events recorded in that context
+   */
+  uint64_t GetEventCount (uint32_t context) const;
+  /**
+   * \return the number of cancelled events recorded
+   */
+  uint64_t GetCancelledCount (void) const;
+
+  /**
+   * \param os output stream
+   *
+   * Print the event types, then the contexts, sorted by decreasing
+   * cumulative time.
+   */
+  void Report (std::ostream &os) const;
+
+private:
+  struct Stats
+  {
+    Stats () : count (0), ns (0) {}
+    uint64_t count;
+    uint64_t ns;
+  };
+
+  static uint64_t GetNanoSeconds (void);
+  static std::string Demangle (const char *mangled);
+
+  uint64_t m_start;
+  // keyed by the address of std::type_info::name, which is cheap to
+  // compare but may differ for a type instantiated in several libraries:
+  // Report merges the entries by demangled name
+  std::map<const char *, Stats> m_types;
+  std::map<uint32_t, Stats> m_contexts;
+  Stats m_cancelled;
+  Stats m_total;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,392 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log.h"
+#include "nstime.h"
+#include "fatal-error.h"
+#include "async-writer.h"
+#include "checkpoint.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "system-mutex.h"
+#include <pthread.h>
+#endif
+
+#include <map>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <string.h>
+
+/*
+ * File layout, in host byte order:
+ *   header: "NS3BLOG1", int64_t femtoseconds per time step
+ *   component record: 'C', uint16_t id, uint16_t name length, name
+ *   log record: 'R', int64_t time step (-1 if none), uint32_t context,
+ *     uint16_t component id, uint32_t level, uint16_t function length,
+ *     uint32_t message length, function, message
+ */
+
+namespace ns3 {
+
+namespace {
+
+const char g_magic[8] = { 'N', 'S', '3', 'B', 'L', 'O', 'G', '1' };
+// largest message stored, longer ones are truncated
+const uint32_t MAX_MESSAGE_SIZE = 64 * 1024;
+
+/**
+ * The records are written to the file by an AsyncWriter, outside of
+ * the simulation thread.
+ */
+class BinaryLog
+{
+public:
+  BinaryLog (std::string filename);
+  ~BinaryLog ();
+  void Write (const void *buffer, uint32_t size);
+
+private:
+  enum
+  {
+    RING_SIZE = 4 * 1024 * 1024
+  };
+  void Consume (const uint8_t *data, uint32_t size);
+
+  std::ofstream m_file;
+  AsyncWriter *m_writer;
+};
+
+BinaryLog::BinaryLog (std::string filename)
+  : m_file (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc)
+{
+  if (!m_file.good ())
+    {
+      NS_FATAL_ERROR ("Could not open binary log file " << filename);
+    }
+  int64_t fsPerStep = TimeStep (1).GetFemtoSeconds ();
+  m_file.write (g_magic, sizeof (g_magic));
+  m_file.write ((const char *)&fsPerStep, sizeof (fsPerStep));
+  m_writer = new AsyncWriter (RING_SIZE, MakeCallback (&BinaryLog::Consume, this));
+  Checkpoint::RegisterOutput (this, filename);
+}
+
+BinaryLog::~BinaryLog ()
+{
+  delete m_writer;
+  m_file.close ();
+  Checkpoint::UnregisterOutput (this);
+}
+
+void
+BinaryLog::Consume (const uint8_t *data, uint32_t size)
+{
+  m_file.write ((const char *)data, size);
+}
+
+void
+BinaryLog::Write (const void *buffer, uint32_t size)
+{
+  m_writer->Write (buffer, size);
+}
+
+BinaryLog *g_binaryLog = 0;
+LogStampGetter g_logStampGetter = 0;
+std::map<const LogComponent *, uint16_t> g_binaryComponents;
+
+/**
+ * Serialize the accesses to g_binaryLog and g_binaryComponents: the
+ * realtime simulator and the distributed simulators may log from several
+ * threads, and the record of a component must be written before the
+ * first message which uses its id.
+ */
+class BinaryLogLock
+{
+public:
+  BinaryLogLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    GetMutex ()->Lock ();
+#endif
+  }
+  ~BinaryLogLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    GetMutex ()->Unlock ();
+#endif
+  }
+private:
+#ifdef HAVE_PTHREAD_H
+  static SystemMutex *GetMutex (void)
+  {
+    // never deleted: messages may be logged by static destructors
+    static SystemMutex *mutex = new SystemMutex ();
+    return mutex;
+  }
+#endif
+};
+
+/**
+ * The stream a message is formatted into and the record it is copied to,
+ * owned by each thread so that messages are formatted without locking.
+ */
+struct Staging
+{
+  std::ostringstream message;
+  std::vector<char> record;
+};
+
+#ifdef HAVE_PTHREAD_H
+/* The staging of a thread is deleted when it exits by the destructor of
+ * this key.
+ */
+pthread_key_t g_stagingKey;
+pthread_once_t g_stagingKeyOnce = PTHREAD_ONCE_INIT;
+
+void
+DeleteStaging (void *staging)
+{
+  delete static_cast<Staging *> (staging);
+}
+
+void
+CreateStagingKey (void)
+{
+  pthread_key_create (&g_stagingKey, &DeleteStaging);
+}
+#endif /* HAVE_PTHREAD_H */
+
+#ifdef HAVE_TLS
+__thread Staging *g_staging = 0;
+#endif
+
+Staging *
+GetStaging (void)
+{
+#ifdef HAVE_TLS
+  if (g_staging != 0)
+    {
+      return g_staging;
+    }
+#endif
+#ifdef HAVE_PTHREAD_H
+  pthread_once (&g_stagingKeyOnce, &CreateStagingKey);
+  Staging *staging = static_cast<Staging *> (pthread_getspecific (g_stagingKey));
+  if (staging == 0)
+    {
+      staging = new Staging ();
+      pthread_setspecific (g_stagingKey, staging);
+    }
+#else
+  static Staging *staging = new Staging ();
+#endif
+#ifdef HAVE_TLS
+  g_staging = staging;
+#endif
+  return staging;
+}
+
+template <typename T>
+void
+Append (std::vector<char> &buffer, T value)
+{
+  const char *bytes = (const char *)&value;
+  buffer.insert (buffer.end (), bytes, bytes + sizeof (T));
+}
+
+template <typename T>
+bool
+Read (std::istream &is, T &value)
+{
+  is.read ((char *)&value, sizeof (T));
+  return is.good ();
+}
+
+static class BinaryLogCloser
+{
+public:
+  ~BinaryLogCloser ()
+  {
+    LogBinaryDisable ();
+  }
+} g_binaryLogCloser;
+
+} // anonymous namespace
+
+void
+LogSetStampGetter (LogStampGetter getter)
+{
+  g_logStampGetter = getter;
+}
+
+void
+LogBinaryEnable (std::string filename)
+{
+  LogBinaryDisable ();
+  BinaryLog *log = new BinaryLog (filename);
+  BinaryLogLock lock;
+  g_binaryLog = log;
+}
+
+void
+LogBinaryDisable (void)
+{
+  BinaryLog *log;
+  {
+    BinaryLogLock lock;
+    log = g_binaryLog;
+    g_binaryLog = 0;
+    g_binaryComponents.clear ();
+  }
+  // the writer logs while it is destroyed: this goes to the text sink now
+  delete log;
+}
+
+bool
+LogBinaryIsEnabled (void)
+{
+  return g_binaryLog != 0;
+}
+
+std::ostream &
+LogBinaryStart (void)
+{
+  Staging *staging = GetStaging ();
+  staging->message.str ("");
+  staging->message.clear ();
+  return staging->message;
+}
+
+void
+LogBinaryCommit (const LogComponent &component, enum LogLevel level, const char *function)
+{
+  Staging *staging = GetStaging ();
+  std::string message = staging->message.str ();
+  std::vector<char> &record = staging->record;
+  record.clear ();
+  int64_t timeStep = -1;
+  uint32_t context = 0xffffffff;
+  if (g_logStampGetter != 0)
+    {
+      (*g_logStampGetter)(timeStep, context);
+    }
+
+  BinaryLogLock lock;
+  if (g_binaryLog == 0)
+    {
+      // disabled by another thread
+      return;
+    }
+  std::map<const LogComponent *, uint16_t>::iterator i = g_binaryComponents.find (&component);
+  if (i == g_binaryComponents.end ())
+    {
+      uint16_t id = g_binaryComponents.size ();
+      i = g_binaryComponents.insert (std::make_pair (&component, id)).first;
+      const char *name = component.Name ();
+      uint16_t length = strlen (name);
+      record.push_back ('C');
+      Append (record, id);
+      Append (record, length);
+      record.insert (record.end (), name, name + length);
+    }
+
+  uint32_t messageLength = std::min<uint32_t> (message.size (), MAX_MESSAGE_SIZE);
+  uint16_t functionLength = strlen (function);
+  record.push_back ('R');
+  Append (record, timeStep);
+  Append (record, context);
+  Append (record, i->second);
+  Append (record, (uint32_t)level);
+  Append (record, functionLength);
+  Append (record, messageLength);
+  record.insert (record.end (), function, function + functionLength);
+  record.insert (record.end (), message.data (), message.data () + messageLength);
+  g_binaryLog->Write (&record[0], record.size ());
+}
+
+void
+LogBinaryDecode (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (g_magic)];
+  int64_t fsPerStep;
+  is.read (magic, sizeof (magic));
+  if (!is.good () || memcmp (magic, g_magic, sizeof (magic)) != 0 || !Read (is, fsPerStep))
+    {
+      NS_FATAL_ERROR ("Not a binary log file");
+    }
+  std::map<uint16_t, std::string> components;
+  std::string buffer;
+  char type;
+  while (Read (is, type))
+    {
+      if (type == 'C')
+        {
+          uint16_t id;
+          uint16_t length;
+          Read (is, id);
+          Read (is, length);
+          buffer.resize (length);
+          is.read (&buffer[0], length);
+          components[id] = buffer;
+          continue;
+        }
+      if (type != 'R')
+        {
+          NS_FATAL_ERROR ("Corrupted binary log file");
+        }
+      int64_t timeStep;
+      uint32_t context;
+      uint16_t id;
+      uint32_t level;
+      uint16_t functionLength;
+      uint32_t messageLength;
+      Read (is, timeStep);
+      Read (is, context);
+      Read (is, id);
+      Read (is, level);
+      Read (is, functionLength);
+      if (!Read (is, messageLength))
+        {
+          break;
+        }
+      buffer.resize (functionLength + messageLength);
+      is.read (&buffer[0], buffer.size ());
+      if (timeStep >= 0)
+        {
+          os << timeStep * (fsPerStep / 1e15) << "s ";
+          if (context == 0xffffffff)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << context << " ";
+            }
+        }
+      os << components[id] << ":" << buffer.substr (0, functionLength);
+      if (level == LOG_FUNCTION)
+        {
+          os << "(" << buffer.substr (functionLength) << ")" << std::endl;
+        }
+      else
+        {
+          os << "(): " << buffer.substr (functionLength) << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -204,6 +204,12 @@ void LogComponentDisableAll (enum LogLevel level);
     {                                                           \
       if (g_log.IsEnabled (level))                              \
         {                                                       \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              ns3::LogBinaryStart () << msg;                    \
+              ns3::LogBinaryCommit (g_log, level, __FUNCTION__); \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -259,6 +265,13 @@ void LogComponentDisableAll (enum LogLevel level);
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              ns3::LogBinaryStart ();                           \
+              ns3::LogBinaryCommit (g_log, ns3::LOG_FUNCTION,   \
+                                    __FUNCTION__);              \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -290,6 +303,14 @@ void LogComponentDisableAll (enum LogLevel level);
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          if (ns3::LogBinaryIsEnabled ())                       \
+            {                                                   \
+              ns3::ParameterLogger (ns3::LogBinaryStart ())     \
+                << parameters;                                  \
+              ns3::LogBinaryCommit (g_log, ns3::LOG_FUNCTION,   \
+                                    __FUNCTION__);              \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -358,6 +379,59 @@ LogTimePrinter LogGetTimePrinter (void);
 void LogSetNodePrinter (LogNodePrinter);
 LogNodePrinter LogGetNodePrinter (void);
 
+typedef void (*LogStampGetter)(int64_t &timeStep, uint32_t &context);
+
+void LogSetStampGetter (LogStampGetter);
+
+class LogComponent;
+
+/**
+ * \param filename the file to write the log records to
+ *
+ * Switch the NS_LOG macros, except NS_LOG_UNCOND, to binary mode: instead
+ * of printing each message with its prefixes to std::clog, store the raw
+ * simulation time, context, component, level, function name and message
+ * in a binary record.  The records are queued in a ring buffer which a
+ * separate thread, if threading is enabled, writes to the file.  Use
+ * LogBinaryDecode or the print-binary-log program to render the file as
+ * text afterwards.  NS_LOG_APPEND_CONTEXT is not recorded.
+ *
+ * The file is written in the byte order of the host and records time
+ * steps of the resolution set when this function is called.
+ */
+void LogBinaryEnable (std::string filename);
+/**
+ * Write the pending records, close the file and go back to text mode.
+ * This is called automatically at exit.
+ */
+void LogBinaryDisable (void);
+/**
+ * \returns true if LogBinaryEnable was called and LogBinaryDisable was not.
+ */
+bool LogBinaryIsEnabled (void);
+/**
+ * \returns the stream the NS_LOG macros format the next message of the
+ *          calling thread into.
+ */
+std::ostream &LogBinaryStart (void);
+/**
+ * \param component the component which logs the message
+ * \param level the level of the message
+ * \param function the name of the function which logs the message
+ *
+ * Queue a record for the message formatted into the stream returned by
+ * the last call to LogBinaryStart in the calling thread.
+ */
+void LogBinaryCommit (const LogComponent &component, enum LogLevel level, const char *function);
+/**
+ * \param is a stream on a file written in binary mode
+ * \param os the stream to print the log messages to
+ *
+ * Print the messages with all prefixes, as they would have been printed to
+ * std::clog with LOG_PREFIX_TIME, LOG_PREFIX_NODE and LOG_PREFIX_FUNC.
+ */
+void LogBinaryDecode (std::istream &is, std::ostream &os);
+
 
 class LogComponent {
 public:
@@ -0,0 +1,358 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-accounting.h"
+#include "global-value.h"
+#include "boolean.h"
+#include "string.h"
+#include "fatal-error.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "system-mutex.h"
+#endif
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+namespace {
+
+GlobalValue g_memoryAccounting = GlobalValue ("MemoryAccounting",
+                                              "Account live memory per type and per context, "
+                                              "and report it in Simulator::Destroy",
+                                              BooleanValue (false),
+                                              MakeBooleanChecker ());
+
+GlobalValue g_memoryAccountingOutput = GlobalValue ("MemoryAccountingOutput",
+                                                    "File the memory report is written to by "
+                                                    "Simulator::Destroy; the report goes to std::clog if empty.",
+                                                    StringValue (""),
+                                                    MakeStringChecker ());
+
+struct Allocation
+{
+  uint32_t size;
+  MemoryAccounting::Usage *type;
+  MemoryAccounting::Usage *context;
+};
+
+/**
+ * Allocated when accounting is enabled, and never destroyed while it is:
+ * objects may still be freed by static destructors when the process exits.
+ */
+struct State
+{
+  // map nodes are never moved, so that allocations can point to their usage
+  std::map<std::string, MemoryAccounting::Usage> types;
+  std::map<uint32_t, MemoryAccounting::Usage> contexts;
+  std::map<const void *, Allocation> allocations;
+  MemoryAccounting::Usage total;
+};
+
+State *g_state = 0;
+MemoryAccounting::ContextGetter g_contextGetter = 0;
+
+/**
+ * Serialize the accesses to g_state: the realtime simulator and the
+ * distributed simulators may allocate objects and packets from several
+ * threads.
+ */
+class StateLock
+{
+public:
+  StateLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    GetMutex ()->Lock ();
+#endif
+  }
+  ~StateLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    GetMutex ()->Unlock ();
+#endif
+  }
+private:
+#ifdef HAVE_PTHREAD_H
+  static SystemMutex *GetMutex (void)
+  {
+    // never deleted, like g_state
+    static SystemMutex *mutex = new SystemMutex ();
+    return mutex;
+  }
+#endif
+};
+
+void
+Add (MemoryAccounting::Usage *usage, uint32_t size)
+{
+  usage->bytes += size;
+  usage->count++;
+  usage->peakBytes = std::max (usage->peakBytes, usage->bytes);
+}
+
+void
+Remove (MemoryAccounting::Usage *usage, uint32_t size)
+{
+  usage->bytes -= size;
+  usage->count--;
+}
+
+typedef std::pair<const MemoryAccounting::Usage *, std::string> Row;
+
+bool
+CompareRows (const Row &a, const Row &b)
+{
+  return a.first->bytes > b.first->bytes;
+}
+
+void
+PrintRows (std::ostream &os, std::vector<Row> rows)
+{
+  std::sort (rows.begin (), rows.end (), CompareRows);
+  os << std::setw (14) << "bytes" << std::setw (12) << "count"
+     << std::setw (14) << "peak bytes" << "  name" << std::endl;
+  for (std::vector<Row>::const_iterator i = rows.begin (); i != rows.end (); ++i)
+    {
+      os << std::setw (14) << i->first->bytes
+         << std::setw (12) << i->first->count
+         << std::setw (14) << i->first->peakBytes
+         << "  " << i->second << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+bool MemoryAccounting::g_enabled = false;
+
+MemoryAccounting::Usage::Usage ()
+  : bytes (0),
+    count (0),
+    peakBytes (0)
+{
+}
+
+void
+MemoryAccounting::Enable (void)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      g_state = new State ();
+    }
+  g_enabled = true;
+}
+
+void
+MemoryAccounting::Disable (void)
+{
+  StateLock lock;
+  g_enabled = false;
+  delete g_state;
+  g_state = 0;
+}
+
+void
+MemoryAccounting::Allocate (const void *p, const std::string &name, uint32_t size)
+{
+  uint32_t context = 0xffffffff;
+  if (g_contextGetter != 0)
+    {
+      context = (*g_contextGetter)();
+    }
+  StateLock lock;
+  if (g_state == 0)
+    {
+      // disabled since the caller checked
+      return;
+    }
+  Allocation allocation;
+  allocation.size = size;
+  allocation.type = &g_state->types[name];
+  allocation.context = &g_state->contexts[context];
+  std::pair<std::map<const void *, Allocation>::iterator, bool> inserted =
+    g_state->allocations.insert (std::make_pair (p, allocation));
+  if (!inserted.second)
+    {
+      // the previous owner of this address was freed without telling us
+      Allocation &old = inserted.first->second;
+      Remove (old.type, old.size);
+      Remove (old.context, old.size);
+      Remove (&g_state->total, old.size);
+      old = allocation;
+    }
+  Add (allocation.type, size);
+  Add (allocation.context, size);
+  Add (&g_state->total, size);
+}
+
+void
+MemoryAccounting::Free (const void *p)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return;
+    }
+  std::map<const void *, Allocation>::iterator i = g_state->allocations.find (p);
+  if (i == g_state->allocations.end ())
+    {
+      return;
+    }
+  Remove (i->second.type, i->second.size);
+  Remove (i->second.context, i->second.size);
+  Remove (&g_state->total, i->second.size);
+  g_state->allocations.erase (i);
+}
+
+void
+MemoryAccounting::SetContext (const void *p, uint32_t context)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return;
+    }
+  std::map<const void *, Allocation>::iterator i = g_state->allocations.find (p);
+  if (i == g_state->allocations.end ())
+    {
+      return;
+    }
+  Remove (i->second.context, i->second.size);
+  i->second.context = &g_state->contexts[context];
+  Add (i->second.context, i->second.size);
+}
+
+MemoryAccounting::Usage
+MemoryAccounting::GetUsage (const std::string &name)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return Usage ();
+    }
+  std::map<std::string, Usage>::const_iterator i = g_state->types.find (name);
+  if (i == g_state->types.end ())
+    {
+      return Usage ();
+    }
+  return i->second;
+}
+
+MemoryAccounting::Usage
+MemoryAccounting::GetContextUsage (uint32_t context)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return Usage ();
+    }
+  std::map<uint32_t, Usage>::const_iterator i = g_state->contexts.find (context);
+  if (i == g_state->contexts.end ())
+    {
+      return Usage ();
+    }
+  return i->second;
+}
+
+MemoryAccounting::Usage
+MemoryAccounting::GetTotalUsage (void)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return Usage ();
+    }
+  return g_state->total;
+}
+
+void
+MemoryAccounting::Report (std::ostream &os)
+{
+  StateLock lock;
+  if (g_state == 0)
+    {
+      return;
+    }
+  std::vector<Row> rows;
+  for (std::map<std::string, Usage>::const_iterator i = g_state->types.begin (); i != g_state->types.end (); ++i)
+    {
+      rows.push_back (Row (&i->second, i->first));
+    }
+  os << "Memory usage: " << g_state->total.bytes << " bytes in " << g_state->total.count
+     << " allocations, peak " << g_state->total.peakBytes << " bytes" << std::endl;
+  os << "By type:" << std::endl;
+  PrintRows (os, rows);
+
+  rows.clear ();
+  for (std::map<uint32_t, Usage>::const_iterator i = g_state->contexts.begin (); i != g_state->contexts.end (); ++i)
+    {
+      std::ostringstream name;
+      if (i->first == 0xffffffff)
+        {
+          name << "no context";
+        }
+      else
+        {
+          name << "node " << i->first;
+        }
+      rows.push_back (Row (&i->second, name.str ()));
+    }
+  os << "By context:" << std::endl;
+  PrintRows (os, rows);
+}
+
+void
+MemoryAccounting::WriteReport (void)
+{
+  StringValue output;
+  g_memoryAccountingOutput.GetValue (output);
+  if (output.Get ().empty ())
+    {
+      Report (std::clog);
+      return;
+    }
+  std::ofstream os (output.Get ().c_str ());
+  if (!os.good ())
+    {
+      NS_FATAL_ERROR ("Could not open memory accounting output " << output.Get ());
+    }
+  Report (os);
+}
+
+void
+MemoryAccounting::SetContextGetter (ContextGetter getter)
+{
+  g_contextGetter = getter;
+  if (getter == 0)
+    {
+      return;
+    }
+  BooleanValue enabled;
+  g_memoryAccounting.GetValue (enabled);
+  if (enabled.Get ())
+    {
+      Enable ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief Account live memory per type and per context
+ *
+ * When enabled, objects created by CreateObject, CopyObject and
+ * ObjectFactory, packets and packet buffers record their size, the name
+ * of their type and the context (node id) of the event which allocated
+ * them.  Live bytes, live counts and peaks can be queried at any time and
+ * a report is written by Simulator::Destroy.  Allocations made before
+ * accounting was enabled are ignored.
+ *
+ * Allocations made outside of any event, notably while the simulation is
+ * set up, are accounted to the "no context" entry.  The exceptions are
+ * the nodes, their devices and applications and the objects aggregated
+ * to them, which Node moves to its own context with SetContext when they
+ * are attached to it.  The other objects built during the setup, such as
+ * those held by the devices, are not attributed to any node: the
+ * per-node numbers only cover them if they are allocated inside events.
+ *
+ * The accounting is serialized by a mutex, since the realtime simulator
+ * may allocate from several threads.
+ *
+ * Accounting is enabled with the "MemoryAccounting" global value (for
+ * example with --MemoryAccounting=1 on the command line) when the
+ * simulator is first used, or explicitly with Enable.  When disabled,
+ * the only cost is the test of a global flag.
+ */
+class MemoryAccounting
+{
+public:
+  struct Usage
+  {
+    Usage ();
+    /// live bytes
+    uint64_t bytes;
+    /// live allocations
+    uint64_t count;
+    /// largest value reached by bytes
+    uint64_t peakBytes;
+  };
+
+  /**
+   * Start accounting allocations.
+   */
+  static void Enable (void);
+  /**
+   * Stop accounting allocations and forget the recorded ones.
+   */
+  static void Disable (void);
+  /**
+   * \return true if allocations are accounted
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \param p the address of the new allocation
+   * \param name the name of its type
+   * \param size its size in bytes
+   */
+  static void Allocate (const void *p, const std::string &name, uint32_t size);
+  /**
+   * \param p the address of an allocation about to be freed
+   *
+   * Unknown addresses are ignored.
+   */
+  static void Free (const void *p);
+  /**
+   * \param p the address of an accounted allocation
+   * \param context the context (node id) it should now be accounted to
+   *
+   * Unknown addresses are ignored.
+   */
+  static void SetContext (const void *p, uint32_t context);
+
+  /**
+   * \param name the name of a type
+   * \return the memory used by allocations of that type
+   */
+  static Usage GetUsage (const std::string &name);
+  /**
+   * \param context a context (node id)
+   * \return the memory used by allocations made in that context
+   */
+  static Usage GetContextUsage (uint32_t context);
+  /**
+   * \return the memory used by all accounted allocations
+   */
+  static Usage GetTotalUsage (void);
+
+  /**
+   * \param os output stream
+   *
+   * Print the types, then the contexts, sorted by decreasing live bytes.
+   */
+  static void Report (std::ostream &os);
+  /**
+   * Write the report to the file named by the "MemoryAccountingOutput"
+   * global value, or to std::clog if it is empty.
+   */
+  static void WriteReport (void);
+
+  typedef uint32_t (*ContextGetter)(void);
+  /**
+   * \param getter returns the context of the current event
+   *
+   * Set by the simulator when it is created, which also enables
+   * accounting if the "MemoryAccounting" global value is true, and reset
+   * to zero when it is destroyed.
+   */
+  static void SetContextGetter (ContextGetter getter);
+
+private:
+  static bool g_enabled;
+};
+
+inline bool
+MemoryAccounting::IsEnabled (void)
+{
+  return g_enabled;
+}
+
+} // namespace ns3
+
+#endif /* MEMORY_ACCOUNTING_H */
@@ -39,6 +39,8 @@ public:
 
   NameNode *m_parent;
   std::string m_name;
+  // path from the root, without the "/Names/" prefix
+  std::string m_path;
   Ptr<Object> m_object;
 
   std::map<std::string, NameNode *> m_nameMap;
@@ -53,6 +55,7 @@ NameNode::NameNode (const NameNode &nameNode)
 {
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
+  m_path = nameNode.m_path;
   m_object = nameNode.m_object;
   m_nameMap = nameNode.m_nameMap;
 }
@@ -62,6 +65,7 @@ NameNode::operator = (const NameNode &rhs)
 {
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
+  m_path = rhs.m_path;
   m_object = rhs.m_object;
   m_nameMap = rhs.m_nameMap;
   return *this;
@@ -70,6 +74,14 @@ NameNode::operator = (const NameNode &rhs)
 NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
   : m_parent (parent), m_name (name), m_object (object)
 {
+  if (parent == 0 || parent->m_parent == 0)
+    {
+      m_path = name;
+    }
+  else
+    {
+      m_path = parent->m_path + "/" + name;
+    }
 }
 
 NameNode::~NameNode ()
@@ -105,9 +117,14 @@ private:
 
   NameNode *IsNamed (Ptr<Object>);
   bool IsDuplicateName (NameNode *node, std::string name);
+  void UpdatePaths (NameNode *node);
 
   NameNode m_root;
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  // every named object, keyed by its raw pointer since the NameNode holds
+  // a reference to it
+  std::map<Object *, NameNode *> m_objectMap;
+  // every NameNode, keyed by its path so that Find needs a single lookup
+  std::map<std::string, NameNode *> m_pathMap;
 };
 
 NamesPriv *
@@ -140,13 +157,14 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::map<Object *, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_pathMap.clear ();
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
@@ -256,7 +274,8 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  m_objectMap[PeekPointer (object)] = newNode;
+  m_pathMap[newNode->m_path] = newNode;
 
   return true;
 }
@@ -378,16 +397,42 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      UpdatePaths (changeNode);
       return true;
     }
 }
 
+void
+NamesPriv::UpdatePaths (NameNode *node)
+{
+  NS_LOG_FUNCTION (node);
+
+  //
+  // The paths of the node and of everything below it have changed: move
+  // them in the path map.
+  //
+  m_pathMap.erase (node->m_path);
+  if (node->m_parent == &m_root)
+    {
+      node->m_path = node->m_name;
+    }
+  else
+    {
+      node->m_path = node->m_parent->m_path + "/" + node->m_name;
+    }
+  m_pathMap[node->m_path] = node;
+  for (std::map<std::string, NameNode *>::iterator i = node->m_nameMap.begin (); i != node->m_nameMap.end (); ++i)
+    {
+      UpdatePaths (i->second);
+    }
+}
+
 std::string
 NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -405,7 +450,7 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -446,78 +491,31 @@ NamesPriv::Find (std::string path)
   // name in the root namespace.
   //
   std::string namespaceName = "/Names/";
-  std::string remaining;
+  std::map<std::string, NameNode *>::iterator i;
 
-  std::string::size_type offset = path.find (namespaceName);
-  if (offset == 0)
+  if (path.compare (0, namespaceName.size (), namespaceName) == 0)
     {
       NS_LOG_LOGIC (path << " is a fully qualified name");
-      remaining = path.substr (namespaceName.size ());
+      i = m_pathMap.find (path.substr (namespaceName.size ()));
     }
   else
     {
       NS_LOG_LOGIC (path << " begins with a relative name");
-      remaining = path;
+      i = m_pathMap.find (path);
     }
 
-  NameNode *node = &m_root;
-
-  //
-  // The string <remaining> is now composed entirely of path segments in
-  // the /Names name space and we have eaten the leading slash. e.g., 
-  // remaining = "ClientNode/eth0"
   //
-  // The start of the search is always at the root of the name space.
+  // The path map holds every name in the /Names name space by its path
+  // from the root, e.g., "ClientNode/eth0", so there is no need to walk the
+  // tree segment by segment.
   //
-  for (;;)
+  if (i == m_pathMap.end ())
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
-        {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
-        }
-      else
-        {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
-        }
+      NS_LOG_LOGIC ("Name does not exist in path map");
+      return 0;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
+  NS_LOG_LOGIC ("Name parsed, found object");
+  return i->second->m_object;
 }
 
 Ptr<Object>
@@ -572,7 +570,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -137,6 +137,11 @@ namespace ns3 {
  * is smaller than 2^64 nanoseconds which is the maximum duration of your simulation
  * if the global resolution is nanoseconds.
  *
+ * When ns-3 is configured with --time-resolution, the resolution is
+ * fixed at compile time: integer conversions such as GetNanoSeconds
+ * become a multiplication or division by a constant, and SetResolution
+ * only accepts that resolution.
+ *
  * Finally, don't even think about ever changing the global resolution after
  * creating Time objects: all Time objects created before the call to SetResolution
  * will contain values which are not updated to the new resolution. In practice,
@@ -346,6 +351,18 @@ public:
    */
   inline static Time FromInteger (uint64_t value, enum Unit timeUnit)
   {
+#ifdef NS3_TIME_RESOLUTION
+    int shift = GetShift (timeUnit);
+    if (shift >= 0)
+      {
+        value *= GetFactor (shift);
+      }
+    else
+      {
+        value /= GetFactor (-shift);
+      }
+    return Time (value);
+#else
     struct Information *info = PeekInformation (timeUnit);
     if (info->fromMul)
       {
@@ -356,6 +373,7 @@ public:
         value /= info->factor;
       }
     return Time (value);
+#endif /* NS3_TIME_RESOLUTION */
   }
   /**
    * \param timeUnit the unit of the value to return
@@ -366,6 +384,14 @@ public:
    */
   inline int64_t ToInteger (enum Unit timeUnit) const
   {
+#ifdef NS3_TIME_RESOLUTION
+    int shift = GetShift (timeUnit);
+    if (shift > 0)
+      {
+        return m_data / GetFactor (shift);
+      }
+    return m_data * GetFactor (-shift);
+#else
     struct Information *info = PeekInformation (timeUnit);
     int64_t v = m_data;
     if (info->toMul)
@@ -374,9 +400,11 @@ public:
       }
     else
       {
-        v /= info->factor; 
+        // a signed division, or negative times come out wrong
+        v /= (int64_t)info->factor;
       }
     return v;
+#endif /* NS3_TIME_RESOLUTION */
   }
   /**
    * \param value to convert into a Time object
@@ -466,6 +494,34 @@ private:
   {
     return &(PeekResolution ()->info[timeUnit]);
   }
+#ifdef NS3_TIME_RESOLUTION
+  /**
+   * \returns the power of ten between timeUnit and the resolution
+   *          fixed at configure time, positive if timeUnit is coarser.
+   *
+   * Callers always pass a constant unit so that, once inlined, this and
+   * GetFactor fold into a constant.
+   */
+  static inline int GetShift (enum Unit timeUnit)
+  {
+    return 3 * (NS3_TIME_RESOLUTION - (int)timeUnit);
+  }
+  static inline int64_t GetFactor (int shift)
+  {
+    switch (shift)
+      {
+      case 0: return 1;
+      case 3: return 1000LL;
+      case 6: return 1000000LL;
+      case 9: return 1000000000LL;
+      case 12: return 1000000000000LL;
+      case 15: return 1000000000000000LL;
+      default:
+        NS_ASSERT_MSG (false, "Invalid time shift " << shift);
+        return 0;
+      }
+  }
+#endif /* NS3_TIME_RESOLUTION */
 
   static struct Resolution GetNsResolution (void);
   static void SetResolution (enum Unit unit, struct Resolution *resolution);
@@ -18,11 +18,14 @@
  * Authors: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "object-base.h"
+#include "memory-accounting.h"
 #include "log.h"
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
 #include "string.h"
 #include "ns3/core-config.h"
+#include <map>
+#include <vector>
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
 #endif
@@ -50,88 +53,186 @@ ObjectBase::GetTypeId (void)
 
 ObjectBase::~ObjectBase () 
 {
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Free (this);
+    }
 }
 
 void
 ObjectBase::NotifyConstructionCompleted (void)
 {}
 
-void
-ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+namespace {
+
+/**
+ * One attribute to initialize when constructing an object.
+ */
+struct ConstructAttribute
 {
-  // loop over the inheritance tree back to the Object base class.
-  TypeId tid = GetInstanceTypeId ();
+  TypeId tid;
+  uint32_t index;
+  std::string name;
+  std::string fullName;
+  Ptr<const AttributeAccessor> accessor;
+  Ptr<const AttributeChecker> checker;
+  // the initial value last seen, and its validated copy
+  Ptr<const AttributeValue> initialValue;
+  Ptr<AttributeValue> validInitialValue;
+};
+typedef std::vector<struct ConstructAttribute> ConstructPlan;
+
+/**
+ * \returns the ATTR_CONSTRUCT attributes of tid and of its parents up to
+ *          ObjectBase, computed once per type.
+ *
+ * Attributes are all registered when a type is first registered, that is,
+ * before any instance of it can be constructed, so the list never needs
+ * to be recomputed.  The initial values can change with
+ * Config::SetDefault so their snapshot is refreshed by ConstructSelf.
+ */
+ConstructPlan &
+GetConstructPlan (TypeId tid)
+{
+  static std::map<TypeId, ConstructPlan> plans;
+  std::map<TypeId, ConstructPlan>::iterator i = plans.find (tid);
+  if (i != plans.end ())
+    {
+      return i->second;
+    }
+  ConstructPlan &plan = plans[tid];
   do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
+          struct TypeId::AttributeInformation info = tid.GetAttribute (j);
           if (!(info.flags & TypeId::ATTR_CONSTRUCT))
             {
               continue;
             }
-          bool found = false;
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          if (value != 0)
+          struct ConstructAttribute attribute;
+          attribute.tid = tid;
+          attribute.index = j;
+          attribute.name = info.name;
+          attribute.fullName = tid.GetAttributeFullName (j);
+          attribute.accessor = info.accessor;
+          attribute.checker = info.checker;
+          plan.push_back (attribute);
+        }
+      tid = tid.GetParent ();
+    } while (tid != ObjectBase::GetTypeId ());
+  return plan;
+}
+
+typedef std::map<std::string, std::vector<std::string> > EnvDefaults;
+
+/**
+ * \returns the values found in NS_ATTRIBUTE_DEFAULT, by attribute full
+ *          name and in order of appearance, or zero if it is not set.
+ *
+ * The variable is parsed again only when its content changes.
+ */
+const EnvDefaults *
+GetEnvDefaults (void)
+{
+#ifdef HAVE_GETENV
+  static bool parsed = false;
+  static std::string cached;
+  static EnvDefaults defaults;
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar == 0)
+    {
+      return 0;
+    }
+  if (!parsed || cached != envVar)
+    {
+      parsed = true;
+      cached = envVar;
+      defaults.clear ();
+      std::string env = cached;
+      std::string::size_type cur = 0;
+      std::string::size_type next = 0;
+      while (next != std::string::npos)
+        {
+          next = env.find (";", cur);
+          std::string tmp = std::string (env, cur, next-cur);
+          std::string::size_type equal = tmp.find ("=");
+          if (equal != std::string::npos)
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  found = true;
-                  continue;
-                }
-            }              
-          if (!found)
+              std::string name = tmp.substr (0, equal);
+              std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
+              defaults[name].push_back (value);
+            }
+          cur = next + 1;
+        }
+    }
+  return &defaults;
+#else
+  return 0;
+#endif /* HAVE_GETENV */
+}
+
+} // anonymous namespace
+
+void
+ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
+{
+  ConstructPlan &plan = GetConstructPlan (GetInstanceTypeId ());
+  const EnvDefaults *env = GetEnvDefaults ();
+  for (ConstructPlan::iterator i = plan.begin (); i != plan.end (); ++i)
+    {
+      NS_LOG_DEBUG ("try to construct \""<< i->tid.GetName ()<<"::"<<
+                    i->name <<"\"");
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value = attributes.Find (i->checker);
+      if (value != 0)
+        {
+          // We have a matching attribute value.
+          if (DoSet (i->accessor, i->checker, *value))
             {
-              // No matching attribute value so we try to look at the env var.
-#ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
+              NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                            i->name<<"\"");
+              continue;
+            }
+        }
+      bool found = false;
+      if (env != 0)
+        {
+          // No matching attribute value so we try to look at the env var.
+          EnvDefaults::const_iterator j = env->find (i->fullName);
+          if (j != env->end ())
+            {
+              for (std::vector<std::string>::const_iterator k = j->second.begin ();
+                   k != j->second.end (); ++k)
                 {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
+                  if (DoSet (i->accessor, i->checker, StringValue (*k)))
                     {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
-                        {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
-                            {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
-                            }
-                        }
-                      cur = next + 1;
+                      NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                                    i->name <<"\" from env var");
+                      found = true;
+                      break;
                     }
                 }
-#endif /* HAVE_GETENV */
             }
-          if (!found)
+        }
+      if (!found)
+        {
+          // No matching attribute value so we try to set the default value.
+          // Initial values are never modified in place: the snapshot is
+          // stale only if Config::SetDefault stored another one.
+          Ptr<const AttributeValue> initialValue = i->tid.GetAttributeInitialValue (i->index);
+          if (initialValue != i->initialValue)
+            {
+              i->initialValue = initialValue;
+              i->validInitialValue = i->checker->CreateValidValue (*initialValue);
+            }
+          if (i->validInitialValue != 0)
             {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
+              i->accessor->Set (this, *i->validInitialValue);
             }
+          NS_LOG_DEBUG ("construct \""<< i->tid.GetName ()<<"::"<<
+                        i->name <<"\" from initial value.");
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+    }
   NotifyConstructionCompleted ();
 }
 
@@ -79,6 +79,15 @@ MakeObjectMapAccessor (U T::*memberVector)
       // quiet compiler.
       return 0;
     }
+    virtual Ptr<Object> DoGetByIndex (const ObjectBase *object, uint32_t index) const {
+      const T *obj = static_cast<const T *> (object);
+      typename U::const_iterator j = (obj->*m_memberVector).find (index);
+      if (j == (obj->*m_memberVector).end ())
+        {
+          return 0;
+        }
+      return (*j).second;
+    }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
   spec->m_memberVector = memberVector;
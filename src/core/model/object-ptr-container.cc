@@ -98,10 +98,40 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     {
       uint32_t index;
       Ptr<Object> o = DoGet (object, i, &index);
-      v->m_objects.insert (std::pair <uint32_t, Ptr<Object> > (index, o));
+      // indexes usually come in increasing order: hint the map about it
+      v->m_objects.insert (v->m_objects.end (), std::pair <uint32_t, Ptr<Object> > (index, o));
     }
   return true;
 }
+bool
+ObjectPtrContainerAccessor::GetN (const ObjectBase *object, uint32_t *n) const
+{
+  return DoGetN (object, n);
+}
+Ptr<Object>
+ObjectPtrContainerAccessor::GetByIndex (const ObjectBase *object, uint32_t index) const
+{
+  return DoGetByIndex (object, index);
+}
+Ptr<Object>
+ObjectPtrContainerAccessor::DoGetByIndex (const ObjectBase *object, uint32_t index) const
+{
+  uint32_t n;
+  if (!DoGetN (object, &n))
+    {
+      return 0;
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t k;
+      Ptr<Object> o = DoGet (object, i, &k);
+      if (k == index)
+        {
+          return o;
+        }
+    }
+  return 0;
+}
 bool 
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
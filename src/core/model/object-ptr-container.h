@@ -139,9 +139,26 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+
+  /**
+   * \param object the object which holds the container
+   * \param n the number of items in the container
+   * \returns false if the object does not hold this container
+   */
+  bool GetN (const ObjectBase *object, uint32_t *n) const;
+  /**
+   * \param object the object which holds the container, checked with GetN
+   * \param index the index of an item, as reported by Get
+   * \returns the item with that index, or 0 if there is none
+   *
+   * Unlike Get, this does not copy the whole container.
+   */
+  Ptr<Object> GetByIndex (const ObjectBase *object, uint32_t index) const;
 private:
   virtual bool DoGetN (const ObjectBase *object, uint32_t *n) const = 0;
   virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const = 0;
+  // walks the items unless overridden by an accessor which can do better
+  virtual Ptr<Object> DoGetByIndex (const ObjectBase *object, uint32_t index) const;
 };
 
 template <typename T, typename U, typename INDEX>
@@ -165,6 +182,14 @@ MakeObjectPtrContainerAccessor (Ptr<U> (T::*get)(INDEX) const,
       *index = i;
       return (obj->*m_get)(i);
     }
+    virtual Ptr<Object> DoGetByIndex (const ObjectBase *object, uint32_t index) const {
+      const T *obj = static_cast<const T *> (object);
+      if (index >= (obj->*m_getN)())
+        {
+          return 0;
+        }
+      return (obj->*m_get)(index);
+    }
     Ptr<U> (T::*m_get)(INDEX) const;
     INDEX (T::*m_getN)(void) const;
   } *spec = new MemberGetters ();
@@ -24,6 +24,7 @@
 #include "ptr.h"
 #include "attribute.h"
 #include "object-ptr-container.h"
+#include <iterator>
 
 namespace ns3 {
 
@@ -79,6 +80,16 @@ MakeObjectVectorAccessor (U T::*memberVector)
       // quiet compiler.
       return 0;
     }
+    virtual Ptr<Object> DoGetByIndex (const ObjectBase *object, uint32_t index) const {
+      const T *obj = static_cast<const T *> (object);
+      if (index >= (obj->*m_memberVector).size ())
+        {
+          return 0;
+        }
+      typename U::const_iterator j = (obj->*m_memberVector).begin ();
+      std::advance (j, index);
+      return *j;
+    }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
   spec->m_memberVector = memberVector;
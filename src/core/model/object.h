@@ -29,6 +29,7 @@
 #include "object-base.h"
 #include "attribute-construction-list.h"
 #include "simple-ref-count.h"
+#include "memory-accounting.h"
 
 
 namespace ns3 {
@@ -368,6 +369,11 @@ Ptr<T> CopyObject (Ptr<T> object)
 {
   Ptr<T> p = Ptr<T> (new T (*PeekPointer (object)), false);
   NS_ASSERT (p->GetInstanceTypeId () == object->GetInstanceTypeId ());
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (static_cast<ObjectBase *> (PeekPointer (p)),
+                                  p->GetInstanceTypeId ().GetName (), sizeof (T));
+    }
   return p;
 }
 
@@ -376,6 +382,11 @@ Ptr<T> CopyObject (Ptr<const T> object)
 {
   Ptr<T> p = Ptr<T> (new T (*PeekPointer (object)), false);
   NS_ASSERT (p->GetInstanceTypeId () == object->GetInstanceTypeId ());
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (static_cast<ObjectBase *> (PeekPointer (p)),
+                                  p->GetInstanceTypeId ().GetName (), sizeof (T));
+    }
   return p;
 }
 
@@ -384,6 +395,10 @@ Ptr<T> CompleteConstruct (T *p)
 {
   p->SetTypeId (T::GetTypeId ());
   p->Object::Construct (AttributeConstructionList ());
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (static_cast<ObjectBase *> (p), T::GetTypeId ().GetName (), sizeof (T));
+    }
   return Ptr<T> (p, false);
 }
 
@@ -94,6 +94,7 @@ public:
   virtual ~RandomVariableBase ();
   virtual double  GetValue () = 0;
   virtual uint32_t GetInteger ();
+  virtual void GetValues (double *values, uint32_t n);
   virtual RandomVariableBase*   Copy (void) const = 0;
 
 protected:
@@ -124,6 +125,14 @@ uint32_t RandomVariableBase::GetInteger ()
   return (uint32_t)GetValue ();
 }
 
+void RandomVariableBase::GetValues (double *values, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 // -------------------------------------------------------
 
 RandomVariable::RandomVariable ()
@@ -165,6 +174,12 @@ RandomVariable::GetInteger (void) const
   return m_variable->GetInteger ();
 }
 
+void
+RandomVariable::GetValues (double *values, uint32_t n) const
+{
+  m_variable->GetValues (values, n);
+}
+
 RandomVariableBase *
 RandomVariable::Peek (void) const
 {
@@ -210,6 +225,7 @@ public:
    */
   virtual double GetValue (double s, double l);
 
+  virtual void GetValues (double *values, uint32_t n);
   virtual RandomVariableBase*  Copy (void) const;
 
 private:
@@ -266,6 +282,19 @@ double UniformVariableImpl::GetValue (double s, double l)
   return s + m_generator->RandU01 () * (l - s);
 }
 
+void UniformVariableImpl::GetValues (double *values, uint32_t n)
+{
+  if (!m_generator)
+    {
+      m_generator = new RngStream ();
+    }
+  m_generator->RandU01 (values, n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      values[i] = m_min + values[i] * (m_max - m_min);
+    }
+}
+
 RandomVariableBase* UniformVariableImpl::Copy () const
 {
   return new UniformVariableImpl (*this);
@@ -539,6 +568,7 @@ public:
    * \return A random value from this exponential distribution
    */
   virtual double GetValue ();
+  virtual void GetValues (double *values, uint32_t n);
   virtual RandomVariableBase* Copy (void) const;
 
 private:
@@ -588,6 +618,25 @@ double ExponentialVariableImpl::GetValue ()
     }
 }
 
+void ExponentialVariableImpl::GetValues (double *values, uint32_t n)
+{
+  if (m_bound != 0)
+    {
+      // rejections make the number of uniform values needed unknown
+      RandomVariableBase::GetValues (values, n);
+      return;
+    }
+  if (!m_generator)
+    {
+      m_generator = new RngStream ();
+    }
+  m_generator->RandU01 (values, n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      values[i] = -m_mean*log (values[i]);
+    }
+}
+
 RandomVariableBase* ExponentialVariableImpl::Copy () const
 {
   return new ExponentialVariableImpl (*this);
@@ -938,6 +987,7 @@ public:
    * \return A value from this normal distribution
    */
   virtual double GetValue ();
+  virtual void GetValues (double *values, uint32_t n);
   virtual RandomVariableBase* Copy (void) const;
 
   double GetMean (void) const;
@@ -1022,6 +1072,16 @@ double NormalVariableImpl::GetValue ()
     }
 }
 
+void NormalVariableImpl::GetValues (double *values, uint32_t n)
+{
+  // values come in pairs with rejections, so this only saves the virtual
+  // calls
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      values[i] = NormalVariableImpl::GetValue ();
+    }
+}
+
 RandomVariableBase* NormalVariableImpl::Copy () const
 {
   return new NormalVariableImpl (*this);
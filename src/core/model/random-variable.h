@@ -137,6 +137,17 @@ public:
    */
   uint32_t GetInteger (void) const;
 
+  /**
+   * \brief Fill an array with random values from the underlying distribution
+   * \param values the array to fill
+   * \param n the number of values to draw
+   *
+   * This returns the same values as n calls to GetValue, but uniform and
+   * unbounded exponential variables draw them in a single pass over the
+   * generator.
+   */
+  void GetValues (double *values, uint32_t n) const;
+
 private:
   friend std::ostream & operator << (std::ostream &os, const RandomVariable &var);
   friend std::istream & operator >> (std::istream &os, RandomVariable &var);
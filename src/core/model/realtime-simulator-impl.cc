@@ -31,6 +31,7 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "trace-source-accessor.h"
 
 
 #include <math.h>
@@ -58,6 +59,16 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("BatchWindow",
+                   "Run the events due within this time of the current real time "
+                   "without waiting for each of them. It may not exceed HardLimit "
+                   "with SynchronizationMode=HardLimit.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&RealtimeSimulatorImpl::m_batchWindow),
+                   MakeTimeChecker ())
+    .AddTraceSource ("EventLateness",
+                     "How late, in real time, each event starts; negative if early.",
+                     MakeTraceSourceAccessor (&RealtimeSimulatorImpl::m_eventLateness))
   ;
   return tid;
 }
@@ -227,9 +238,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         // as the real time.  This is typically called "pacing" the simulation time.
         //
         // We do have to be careful if we are falling behind.  If so, tsDelay must be
-        // zero.  If we're late, don't dawdle.
+        // zero.  If we're late, don't dawdle.  Events due within the batch window
+        // are run right away too, so that a burst costs a single wait.
         //
-        if (tsNext <= tsNow)
+        if (tsNext <= tsNow + m_batchWindow.GetTimeStep ())
           {
             tsDelay = 0;
           }
@@ -305,6 +317,8 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   // whatever event is at the head of this list if the list is in time order.
   //
   Scheduler::Event next;
+  int64_t tsLateness = 0;
+  bool traceLateness = !m_eventLateness.IsEmpty ();
 
   { 
     CriticalSection cs (m_mutex);
@@ -348,7 +362,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // We check the simulation time against the current real time to make this
     // judgement.
     //
-    if (m_synchronizationMode == SYNC_HARD_LIMIT)
+    if (m_synchronizationMode == SYNC_HARD_LIMIT || traceLateness)
       {
         uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
         uint64_t tsJitter;
@@ -356,13 +370,16 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         if (tsFinal >= m_currentTs)
           {
             tsJitter = tsFinal - m_currentTs;
+            tsLateness = tsJitter;
           }
         else
           {
             tsJitter = m_currentTs - tsFinal;
+            tsLateness = -(int64_t)tsJitter;
           }
 
-        if (tsJitter > static_cast<uint64_t>(m_hardLimit.GetTimeStep ()))
+        if (m_synchronizationMode == SYNC_HARD_LIMIT &&
+            tsJitter > static_cast<uint64_t>(m_hardLimit.GetTimeStep ()))
           {
             NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
                             "Hard real-time limit exceeded (jitter = " << tsJitter << ")");
@@ -373,8 +390,13 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   //
   // We have got the event we're about to execute completely disentangled from the 
   // event list so we can execute it outside a critical section without fear of someone
-  // changing things out from under us.
+  // changing things out from under us.  This is also why the lateness is
+  // only reported here: a trace sink may well schedule events.
 
+  if (traceLateness)
+    {
+      m_eventLateness (Time (tsLateness));
+    }
   EventImpl *event = next.impl;
   m_synchronizer->EventStart ();
   event->Invoke ();
@@ -415,6 +437,12 @@ RealtimeSimulatorImpl::Run (void)
 
   NS_ASSERT_MSG (m_running == false, 
                  "RealtimeSimulatorImpl::Run(): Simulator already running");
+  // batched events start up to BatchWindow ahead of real time
+  if (m_synchronizationMode == SYNC_HARD_LIMIT && m_batchWindow > m_hardLimit)
+    {
+      NS_FATAL_ERROR ("RealtimeSimulatorImpl::Run(): BatchWindow (" << m_batchWindow.GetSeconds ()
+                      << "s) exceeds HardLimit (" << m_hardLimit.GetSeconds () << "s)");
+    }
 
   // Set the current threadId as the main threadId
   m_main = SystemThread::Self();
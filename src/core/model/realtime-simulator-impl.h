@@ -30,6 +30,7 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "traced-callback.h"
 
 #include <list>
 
@@ -117,6 +118,18 @@ private:
    */
   Time m_hardLimit;
 
+  /**
+   * Events due within this time of the current real time are run
+   * without waiting for them.
+   */
+  Time m_batchWindow;
+
+  /**
+   * Fired before each event with the real time at which it starts minus
+   * its timestamp.
+   */
+  TracedCallback<Time> m_eventLateness;
+
   SystemThread::ThreadId m_main;
 };
 
@@ -554,6 +554,50 @@ double RngStream::RandU01 ()
 }
 
 
+//-------------------------------------------------------------------------
+// Generate the next n random numbers.  The state is kept in locals for the
+// whole block, and each step is computed exactly as in U01 so that the
+// block matches n calls to RandU01.
+//
+void RngStream::RandU01 (double *values, uint32_t n)
+{
+  if (incPrec)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          values[i] = U01d ();
+        }
+      return;
+    }
+  int32_t k;
+  double p1, p2, u;
+  double c0 = Cg[0], c1 = Cg[1], c2 = Cg[2];
+  double c3 = Cg[3], c4 = Cg[4], c5 = Cg[5];
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      /* Component 1 */
+      p1 = a12 * c1 - a13n * c0;
+      k = static_cast<int32_t> (p1 / m1);
+      p1 -= k * m1;
+      if (p1 < 0.0) p1 += m1;
+      c0 = c1; c1 = c2; c2 = p1;
+
+      /* Component 2 */
+      p2 = a21 * c5 - a23n * c3;
+      k = static_cast<int32_t> (p2 / m2);
+      p2 -= k * m2;
+      if (p2 < 0.0) p2 += m2;
+      c3 = c4; c4 = c5; c5 = p2;
+
+      /* Combination */
+      u = ((p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm);
+      values[i] = (anti == false) ? u : (1 - u);
+    }
+  Cg[0] = c0; Cg[1] = c1; Cg[2] = c2;
+  Cg[3] = c3; Cg[4] = c4; Cg[5] = c5;
+}
+
+
 //-------------------------------------------------------------------------
 // Generate the next random integer.
 //
@@ -51,6 +51,8 @@ public:  //public api
   void AdvanceState (int32_t e, int32_t c);
   void GetState (uint32_t seed[6]) const;
   double RandU01 ();
+  // fill values with the next n numbers RandU01 would return
+  void RandU01 (double *values, uint32_t n);
   int32_t RandInt (int32_t i, int32_t j);
 public: //public static api
   static bool SetPackageSeed (uint32_t seed);
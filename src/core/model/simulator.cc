@@ -28,6 +28,7 @@
 #include "string.h"
 #include "object-factory.h"
 #include "global-value.h"
+#include "memory-accounting.h"
 #include "assert.h"
 #include "log.h"
 
@@ -70,6 +71,19 @@ NodePrinter (std::ostream &os)
     }
 }
 
+static void
+StampGetter (int64_t &timeStep, uint32_t &context)
+{
+  timeStep = Simulator::Now ().GetTimeStep ();
+  context = Simulator::GetContext ();
+}
+
+static uint32_t
+ContextGetter (void)
+{
+  return Simulator::GetContext ();
+}
+
 static SimulatorImpl **PeekImpl (void)
 {
   static SimulatorImpl *impl = 0;
@@ -109,6 +123,8 @@ static SimulatorImpl * GetImpl (void)
 //
       LogSetTimePrinter (&TimePrinter);
       LogSetNodePrinter (&NodePrinter);
+      LogSetStampGetter (&StampGetter);
+      MemoryAccounting::SetContextGetter (&ContextGetter);
     }
   return *pimpl;
 }
@@ -130,6 +146,12 @@ Simulator::Destroy (void)
    */
   LogSetTimePrinter (0);
   LogSetNodePrinter (0);
+  LogSetStampGetter (0);
+  MemoryAccounting::SetContextGetter (0);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::WriteReport ();
+    }
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
@@ -345,6 +367,7 @@ Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 //
   LogSetTimePrinter (&TimePrinter);
   LogSetNodePrinter (&NodePrinter);
+  LogSetStampGetter (&StampGetter);
 }
 Ptr<SimulatorImpl>
 Simulator::GetImplementation (void)
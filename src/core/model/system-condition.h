@@ -45,8 +45,10 @@ class SystemConditionPrivate;
  * condition to become true; but the TimedWait has a timeout.
  *
  * The condition underlying this class is a simple boolean variable.  It is
- * set to false in each call to Wait and TimedWait.  It is set to true in each
- * call to Signal and Broadcast.  This is a fairly simple-minded condition
+ * set with SetCondition: to true before Signal and Broadcast, and to false
+ * before the waiting thread checks whatever it waits for, so that a Signal
+ * in between is not missed: Wait and TimedWait return at once if the
+ * condition is already true.  This is a fairly simple-minded condition
  * designed for 
  *
  * A typical use case will be to call Wait() or TimedWait() in one thread
@@ -86,12 +86,20 @@ struct Time::Resolution
 Time::GetNsResolution (void)
 {
   struct Resolution resolution;
+#ifdef NS3_TIME_RESOLUTION
+  SetResolution ((enum Time::Unit)NS3_TIME_RESOLUTION, &resolution);
+#else
   SetResolution (Time::NS, &resolution);
+#endif
   return resolution;
 }
 void 
 Time::SetResolution (enum Unit resolution)
 {
+#ifdef NS3_TIME_RESOLUTION
+  NS_ABORT_MSG_UNLESS (resolution == NS3_TIME_RESOLUTION,
+                       "Time resolution was fixed at configure time and cannot be changed");
+#endif
   SetResolution (resolution, PeekResolution ());
 }
 void 
@@ -20,14 +20,43 @@
 #include "timer.h"
 #include "simulator.h"
 #include "simulation-singleton.h"
+#include "global-value.h"
+#include <map>
 
 namespace ns3 {
 
+static GlobalValue g_timerWheelSlot = GlobalValue ("TimerWheelSlot",
+                                                  "The width of the slots of the timer wheel used by "
+                                                  "the ns3::Timer instances created afterwards, "
+                                                  "or zero to schedule every timer in the simulator directly",
+                                                  TimeValue (TimeStep (0)),
+                                                  MakeTimeChecker ());
+
+namespace {
+
+// timers waiting on the wheel, by context and slot index.  An entry lives
+// from the first timer added to its slot until the slot event fires, even
+// if all its timers are cancelled in between.
+typedef std::map<std::pair<uint32_t, int64_t>, std::list<Timer *> > TimerWheel;
+TimerWheel g_wheel;
+bool g_wheelClearScheduled = false;
+
+Time
+GetTimerWheelSlot (void)
+{
+  TimeValue slot;
+  g_timerWheelSlot.GetValue (slot);
+  return slot.Get ();
+}
+
+} // anonymous namespace
+
 Timer::Timer ()
   : m_flags (CHECK_ON_DESTROY),
     m_delay (FemtoSeconds (0)),
     m_event (),
-    m_impl (0)
+    m_impl (0),
+    m_wheelSlot (GetTimerWheelSlot ())
 {
 }
 
@@ -35,7 +64,8 @@ Timer::Timer (enum DestroyPolicy destroyPolicy)
   : m_flags (destroyPolicy),
     m_delay (FemtoSeconds (0)),
     m_event (),
-    m_impl (0)
+    m_impl (0),
+    m_wheelSlot (GetTimerWheelSlot ())
 {
 }
 
@@ -43,7 +73,7 @@ Timer::~Timer ()
 {
   if (m_flags & CHECK_ON_DESTROY)
     {
-      if (m_event.IsRunning ())
+      if (m_event.IsRunning () || (m_flags & TIMER_WHEELED))
         {
           NS_FATAL_ERROR ("Event is still running while destroying.");
         }
@@ -56,6 +86,7 @@ Timer::~Timer ()
     {
       Simulator::Remove (m_event);
     }
+  Unwheel ();
   delete m_impl;
 }
 
@@ -75,6 +106,10 @@ Timer::GetDelayLeft (void) const
   switch (GetState ())
     {
     case Timer::RUNNING:
+      if (m_flags & TIMER_WHEELED)
+        {
+          return m_expiry - Simulator::Now ();
+        }
       return Simulator::GetDelayLeft (m_event);
       break;
     case Timer::EXPIRED:
@@ -93,22 +128,24 @@ Timer::GetDelayLeft (void) const
 void
 Timer::Cancel (void)
 {
+  Unwheel ();
   Simulator::Cancel (m_event);
 }
 void
 Timer::Remove (void)
 {
+  Unwheel ();
   Simulator::Remove (m_event);
 }
 bool
 Timer::IsExpired (void) const
 {
-  return !IsSuspended () && m_event.IsExpired ();
+  return !IsSuspended () && !(m_flags & TIMER_WHEELED) && m_event.IsExpired ();
 }
 bool
 Timer::IsRunning (void) const
 {
-  return !IsSuspended () && m_event.IsRunning ();
+  return !IsSuspended () && ((m_flags & TIMER_WHEELED) || m_event.IsRunning ());
 }
 bool
 Timer::IsSuspended (void) const
@@ -143,19 +180,27 @@ void
 Timer::Schedule (Time delay)
 {
   NS_ASSERT (m_impl != 0);
-  if (m_event.IsRunning ())
+  if (m_event.IsRunning () || (m_flags & TIMER_WHEELED))
     {
       NS_FATAL_ERROR ("Event is still running while re-scheduling.");
     }
-  m_event = m_impl->Schedule (delay);
+  DoSchedule (delay);
 }
 
 void
 Timer::Suspend (void)
 {
   NS_ASSERT (IsRunning ());
-  m_delayLeft = Simulator::GetDelayLeft (m_event);
-  Simulator::Remove (m_event);
+  if (m_flags & TIMER_WHEELED)
+    {
+      m_delayLeft = m_expiry - Simulator::Now ();
+      Unwheel ();
+    }
+  else
+    {
+      m_delayLeft = Simulator::GetDelayLeft (m_event);
+      Simulator::Remove (m_event);
+    }
   m_flags |= TIMER_SUSPENDED;
 }
 
@@ -163,10 +208,93 @@ void
 Timer::Resume (void)
 {
   NS_ASSERT (m_flags & TIMER_SUSPENDED);
-  m_event = m_impl->Schedule (m_delayLeft);
+  DoSchedule (m_delayLeft);
   m_flags &= ~TIMER_SUSPENDED;
 }
 
+void
+Timer::DoSchedule (const Time &delay)
+{
+  if (m_wheelSlot.IsZero ())
+    {
+      m_event = m_impl->Schedule (delay);
+      return;
+    }
+  Time now = Simulator::Now ();
+  Time expiry = now + delay;
+  int64_t slot = expiry.GetTimeStep () / m_wheelSlot.GetTimeStep ();
+  Time slotStart = TimeStep (slot * m_wheelSlot.GetTimeStep ());
+  if (slotStart <= now)
+    {
+      // the slot has already started: nothing to save by waiting
+      m_event = m_impl->Schedule (delay);
+      return;
+    }
+  uint32_t context = Simulator::GetContext ();
+  std::pair<TimerWheel::iterator, bool> entry =
+    g_wheel.insert (std::make_pair (std::make_pair (context, slot), std::list<Timer *> ()));
+  if (entry.second)
+    {
+      Simulator::Schedule (slotStart - now, &Timer::WheelExpire, context, slot);
+      if (!g_wheelClearScheduled)
+        {
+          Simulator::ScheduleDestroy (&Timer::WheelClear);
+          g_wheelClearScheduled = true;
+        }
+    }
+  std::list<Timer *> &timers = entry.first->second;
+  m_wheelPosition = timers.insert (timers.end (), this);
+  m_expiry = expiry;
+  m_context = context;
+  m_slot = slot;
+  m_flags |= TIMER_WHEELED;
+}
+
+void
+Timer::Unwheel (void)
+{
+  if (!(m_flags & TIMER_WHEELED))
+    {
+      return;
+    }
+  TimerWheel::iterator i = g_wheel.find (std::make_pair (m_context, m_slot));
+  NS_ASSERT (i != g_wheel.end ());
+  i->second.erase (m_wheelPosition);
+  m_flags &= ~TIMER_WHEELED;
+}
+
+void
+Timer::WheelExpire (uint32_t context, int64_t slot)
+{
+  TimerWheel::iterator i = g_wheel.find (std::make_pair (context, slot));
+  NS_ASSERT (i != g_wheel.end ());
+  std::list<Timer *> timers;
+  timers.swap (i->second);
+  g_wheel.erase (i);
+  Time now = Simulator::Now ();
+  for (std::list<Timer *>::iterator j = timers.begin (); j != timers.end (); ++j)
+    {
+      Timer *timer = *j;
+      timer->m_flags &= ~TIMER_WHEELED;
+      timer->m_event = timer->m_impl->Schedule (timer->m_expiry - now);
+    }
+}
+
+void
+Timer::WheelClear (void)
+{
+  // the slot events are gone with the simulator: forget the timers which
+  // were waiting on them so that they look expired
+  for (TimerWheel::iterator i = g_wheel.begin (); i != g_wheel.end (); ++i)
+    {
+      for (std::list<Timer *>::iterator j = i->second.begin (); j != i->second.end (); ++j)
+        {
+          (*j)->m_flags &= ~TIMER_WHEELED;
+        }
+    }
+  g_wheel.clear ();
+  g_wheelClearScheduled = false;
+}
 
 } // namespace ns3
 
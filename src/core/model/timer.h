@@ -24,6 +24,7 @@
 #include "nstime.h"
 #include "event-id.h"
 #include "int-to-type.h"
+#include <list>
 
 namespace ns3 {
 
@@ -41,6 +42,17 @@ class TimerImpl;
  * A timer can also be used to enforce a set of predefined event lifetime
  * management policies. These policies are specified at construction time
  * and cannot be changed after.
+ *
+ * Timers which are re-armed before they expire, such as protocol
+ * timeouts, can be kept on a timer wheel instead of in the simulator event
+ * list, by setting the "TimerWheelSlot" global value to a non-zero slot
+ * width before the timers are created.  The timers of each context (node)
+ * are then grouped by expiration slot and the wheel schedules a single
+ * event at the start of each slot, which moves the timers still running in
+ * that slot to the simulator with their exact expiration time.  Cancelling
+ * or re-arming a timer before its slot starts does not touch the event list
+ * at all.  Expiration times are unchanged, but a timer can run after
+ * other events scheduled for the very same time.
  */
 class Timer
 {
@@ -232,14 +244,26 @@ public:
 private:
   enum
   {
-    TIMER_SUSPENDED = (1 << 7)
+    TIMER_SUSPENDED = (1 << 7),
+    TIMER_WHEELED = (1 << 8)
   };
 
+  void DoSchedule (const Time &delay);
+  void Unwheel (void);
+  static void WheelExpire (uint32_t context, int64_t slot);
+  static void WheelClear (void);
+
   int m_flags;
   Time m_delay;
   EventId m_event;
   TimerImpl *m_impl;
   Time m_delayLeft;
+  // timer wheel state, used when m_wheelSlot is not zero
+  Time m_wheelSlot;
+  Time m_expiry;
+  uint32_t m_context;
+  int64_t m_slot;
+  std::list<Timer *>::iterator m_wheelPosition;
 };
 
 } // namespace ns3
@@ -21,8 +21,10 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
+#include "ns3/core-config.h"
 #include "callback.h"
+#include "fatal-error.h"
 
 namespace ns3 {
 
@@ -44,6 +46,19 @@ class TracedCallback
 {
 public:
   TracedCallback ();
+  /**
+   * \param o the TracedCallback to copy
+   *
+   * Copy the chain of callbacks, but not the state of a call running on o.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * \param o the TracedCallback to copy
+   * \returns this TracedCallback
+   *
+   * Copy the chain of callbacks, but not the state of a call running on o.
+   */
+  TracedCallback &operator = (const TracedCallback &o);
   /**
    * \param callback callback to add to chain of callbacks
    *
@@ -67,6 +82,8 @@ public:
    * Remove the input callback from the internal list 
    * of ns3::Callback. This method is really the symmetric
    * of the TracedCallback::ConnectWithoutContext method.
+   * A callback may disconnect itself, or another callback, while
+   * it is called: the callbacks left are still called.
    */
   void DisconnectWithoutContext (const CallbackBase & callback);
   /**
@@ -78,6 +95,11 @@ public:
    * of the TracedCallback::Connect method.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * \returns true if no callback is connected to this TracedCallback,
+   *          false otherwise.
+   */
+  bool IsEmpty (void) const;
   void operator() (void) const;
   void operator() (T1 a1) const;
   void operator() (T1 a1, T2 a2) const;
@@ -89,8 +111,25 @@ public:
   void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
 
 private:
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * \param disconnected an empty list on the stack of the call
+   *
+   * Keep the callbacks disconnected during the call in this list if the
+   * call is the outermost one.
+   */
+  void BeginCall (CallbackList *disconnected) const;
+  /**
+   * \param disconnected the list given to BeginCall
+   *
+   * Remove the callbacks disconnected while the outermost call was
+   * running.
+   */
+  void EndCall (CallbackList *disconnected) const;
   CallbackList m_callbackList;
+  // set while a call runs: the disconnected callbacks are replaced by
+  // null ones and kept alive in this list, on the stack of the call
+  mutable CallbackList *m_disconnected;
 };
 
 } // namespace ns3
@@ -104,9 +143,29 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_callbackList (),
+    m_disconnected (0)
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_callbackList (o.m_callbackList),
+    m_disconnected (0)
 {
 }
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
+{
+  m_callbackList = o.m_callbackList;
+  return *this;
+}
 template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
@@ -114,6 +173,9 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
 {
+#ifdef NS3_TRACING_DISABLE
+  NS_FATAL_ERROR ("Tracing was disabled at configuration time");
+#endif
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
   m_callbackList.push_back (cb);
@@ -125,6 +187,9 @@ template<typename T1, typename T2,
 void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback, std::string path)
 {
+#ifdef NS3_TRACING_DISABLE
+  NS_FATAL_ERROR ("Tracing was disabled at configuration time");
+#endif
   Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   cb.Assign (callback);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
@@ -140,7 +205,14 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const Callbac
   for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if ((*i).IsEqual (callback) && m_disconnected != 0)
+        {
+          // the callback may be the one running
+          m_disconnected->push_back (*i);
+          *i = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+          i++;
+        }
+      else if ((*i).IsEqual (callback))
         {
           i = m_callbackList.erase (i);
         }
@@ -162,6 +234,19 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+#ifdef NS3_TRACING_DISABLE
+  return true;
+#else
+  return m_callbackList.empty ();
+#endif
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
@@ -169,11 +254,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
     {
-      (*i)();
+      return;
     }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i]();
+        }
+    }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -182,11 +279,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
     {
-      (*i)(a1);
+      return;
     }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1);
+        }
+    }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -195,11 +304,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
+    {
+      return;
+    }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2);
+        }
     }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -208,11 +329,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
     {
-      (*i)(a1, a2, a3);
+      return;
     }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3);
+        }
+    }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -221,11 +354,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
+    {
+      return;
+    }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4);
+        }
     }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -234,11 +379,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
+    {
+      return;
+    }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5);
+        }
     }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -247,11 +404,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      return;
     }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6);
+        }
+    }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -260,11 +429,23 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      return;
     }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7);
+        }
+    }
+  EndCall (&disconnected);
+#endif
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -273,10 +454,63 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+#ifndef NS3_TRACING_DISABLE
+  if (m_callbackList.empty ())
+    {
+      return;
+    }
+  // index rather than iterate: a sink may connect another sink
+  CallbackList disconnected;
+  BeginCall (&disconnected);
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7, a8);
+        }
+    }
+  EndCall (&disconnected);
+#endif
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::BeginCall (CallbackList *disconnected) const
+{
+  if (m_disconnected == 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      m_disconnected = disconnected;
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndCall (CallbackList *disconnected) const
+{
+  if (m_disconnected != disconnected)
+    {
+      // a nested call
+      return;
+    }
+  m_disconnected = 0;
+  if (!disconnected->empty ())
+    {
+      CallbackList &list = const_cast<CallbackList &> (m_callbackList);
+      for (typename CallbackList::iterator i = list.begin (); i != list.end (); /* empty */)
+        {
+          if ((*i).IsNull ())
+            {
+              i = list.erase (i);
+            }
+          else
+            {
+              i++;
+            }
+        }
     }
 }
 
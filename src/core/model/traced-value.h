@@ -88,7 +88,11 @@ public:
     m_cb.Disconnect (cb, path);
   }
   void Set (const T &v) {
-    if (m_v != v)
+    if (m_cb.IsEmpty ())
+      {
+        m_v = v;
+      }
+    else if (m_v != v)
       {
         m_cb (m_v, v);
         m_v = v;
@@ -21,6 +21,7 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 #include <vector>
+#include <map>
 #include <sstream>
 
 /*********************************************************************
@@ -58,6 +59,7 @@ public:
                                 ns3::Ptr<const ns3::AttributeValue> initialValue);
   uint32_t GetAttributeN (uint16_t uid) const;
   struct ns3::TypeId::AttributeInformation GetAttribute(uint16_t uid, uint32_t i) const;
+  ns3::Ptr<const ns3::AttributeValue> GetAttributeInitialValue (uint16_t uid, uint32_t i) const;
   void AddTraceSource (uint16_t uid,
                        std::string name, 
                        std::string help,
@@ -65,6 +67,8 @@ public:
   uint32_t GetTraceSourceN (uint16_t uid) const;
   struct ns3::TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
   bool MustHideFromDocumentation (uint16_t uid) const;
+  const struct ns3::TypeId::AttributeInformation *LookupAttribute (uint16_t uid, std::string name) const;
+  const struct ns3::TypeId::TraceSourceInformation *LookupTraceSource (uint16_t uid, std::string name) const;
 
 private:
   bool HasTraceSource (uint16_t uid, std::string name);
@@ -79,12 +83,17 @@ private:
     bool mustHideFromDocumentation;
     std::vector<struct ns3::TypeId::AttributeInformation> attributes;
     std::vector<struct ns3::TypeId::TraceSourceInformation> traceSources;
+    // name to index in attributes and traceSources, for this type only
+    std::map<std::string, uint32_t> attributeIndex;
+    std::map<std::string, uint32_t> traceSourceIndex;
   };
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
 
   std::vector<struct IidInformation> m_information;
+  // name to uid
+  std::map<std::string, uint16_t> m_uids;
 };
 
 IidManager::IidManager ()
@@ -94,15 +103,10 @@ IidManager::IidManager ()
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
-  uint16_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  if (m_uids.find (name) != m_uids.end ())
     {
-      if (i->name == name)
-        {
-          NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
-          return 0;
-        }
-      j++;
+      NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
+      return 0;
     }
   struct IidInformation information;
   information.name = name;
@@ -113,6 +117,7 @@ IidManager::AllocateUid (std::string name)
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
+  m_uids[name] = uid;
   return uid;
 }
 
@@ -158,17 +163,12 @@ IidManager::AddConstructor (uint16_t uid, ns3::Callback<ns3::ObjectBase *> callb
 uint16_t 
 IidManager::GetUid (std::string name) const
 {
-  uint32_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  std::map<std::string, uint16_t>::const_iterator i = m_uids.find (name);
+  if (i == m_uids.end ())
     {
-      if (i->name == name)
-        {
-          NS_ASSERT (j <= 0xffff);
-          return j;
-        }
-      j++;
+      return 0;
     }
-  return 0;
+  return i->second;
 }
 std::string 
 IidManager::GetName (uint16_t uid) const
@@ -218,31 +218,34 @@ IidManager::GetRegistered (uint32_t i) const
   return i + 1;
 }
 
-bool
-IidManager::HasAttribute (uint16_t uid,
-                          std::string name)
+const struct ns3::TypeId::AttributeInformation *
+IidManager::LookupAttribute (uint16_t uid, std::string name) const
 {
   struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct ns3::TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
+      std::map<std::string, uint32_t>::const_iterator i = information->attributeIndex.find (name);
+      if (i != information->attributeIndex.end ())
         {
-          if (i->name == name)
-            {
-              return true;
-            }
+          return &information->attributes[i->second];
         }
       struct IidInformation *parent = LookupInformation (information->parent);
       if (parent == information)
         {
           // top of inheritance tree
-          return false;
+          return 0;
         }
       // check parent
       information = parent;
     }
-  return false;
+  return 0;
+}
+
+bool
+IidManager::HasAttribute (uint16_t uid,
+                          std::string name)
+{
+  return LookupAttribute (uid, name) != 0;
 }
 
 void 
@@ -268,6 +271,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.originalInitialValue = initialValue;
   info.accessor = accessor;
   info.checker = checker;
+  information->attributeIndex[name] = information->attributes.size ();
   information->attributes.push_back (info);
 }
 void 
@@ -296,31 +300,42 @@ IidManager::GetAttribute(uint16_t uid, uint32_t i) const
   return information->attributes[i];
 }
 
-bool
-IidManager::HasTraceSource (uint16_t uid,
-                            std::string name)
+ns3::Ptr<const ns3::AttributeValue>
+IidManager::GetAttributeInitialValue (uint16_t uid, uint32_t i) const
+{
+  struct IidInformation *information = LookupInformation (uid);
+  NS_ASSERT (i < information->attributes.size ());
+  return information->attributes[i].initialValue;
+}
+
+const struct ns3::TypeId::TraceSourceInformation *
+IidManager::LookupTraceSource (uint16_t uid, std::string name) const
 {
   struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct ns3::TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
-           i != information->traceSources.end (); ++i)
+      std::map<std::string, uint32_t>::const_iterator i = information->traceSourceIndex.find (name);
+      if (i != information->traceSourceIndex.end ())
         {
-          if (i->name == name)
-            {
-              return true;
-            }
+          return &information->traceSources[i->second];
         }
       struct IidInformation *parent = LookupInformation (information->parent);
       if (parent == information)
         {
           // top of inheritance tree
-          return false;
+          return 0;
         }
       // check parent
       information = parent;
     }
-  return false;
+  return 0;
+}
+
+bool
+IidManager::HasTraceSource (uint16_t uid,
+                            std::string name)
+{
+  return LookupTraceSource (uid, name) != 0;
 }
 
 void 
@@ -339,6 +354,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.name = name;
   source.help = help;
   source.accessor = accessor;
+  information->traceSourceIndex[name] = information->traceSources.size ();
   information->traceSources.push_back (source);
 }
 uint32_t 
@@ -414,22 +430,13 @@ TypeId::GetRegistered (uint32_t i)
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  const struct TypeId::AttributeInformation *tmp = Singleton<IidManager>::Get ()->LookupAttribute (m_tid, name);
+  if (tmp == 0)
+    {
+      return false;
+    }
+  *info = *tmp;
+  return true;
 }
 
 TypeId 
@@ -550,6 +557,11 @@ TypeId::GetAttribute(uint32_t i) const
 {
   return Singleton<IidManager>::Get ()->GetAttribute(m_tid, i);
 }
+Ptr<const AttributeValue>
+TypeId::GetAttributeInitialValue (uint32_t i) const
+{
+  return Singleton<IidManager>::Get ()->GetAttributeInitialValue (m_tid, i);
+}
 std::string 
 TypeId::GetAttributeFullName (uint32_t i) const
 {
@@ -588,21 +600,12 @@ TypeId::HideFromDocumentation (void)
 Ptr<const TraceSourceAccessor> 
 TypeId::LookupTraceSourceByName (std::string name) const
 {
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  const struct TypeId::TraceSourceInformation *info = Singleton<IidManager>::Get ()->LookupTraceSource (m_tid, name);
+  if (info == 0)
+    {
+      return 0;
+    }
+  return info->accessor;
 }
 
 uint16_t 
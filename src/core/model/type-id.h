@@ -25,6 +25,7 @@
 #include "trace-source-accessor.h"
 #include "attribute-helper.h"
 #include "callback.h"
+#include "memory-accounting.h"
 #include <string>
 #include <stdint.h>
 
@@ -158,6 +159,14 @@ public:
    *          index is i.
    */
   std::string GetAttributeFullName (uint32_t i) const;
+  /**
+   * \param i index into attribute array
+   * \returns the initial value of the attribute whose index is i.
+   *
+   * Unlike GetAttribute, this does not copy the rest of the
+   * attribute information.
+   */
+  Ptr<const AttributeValue> GetAttributeInitialValue (uint32_t i) const;
 
   /**
    * \returns a callback which can be used to instanciate an object
@@ -390,6 +399,10 @@ TypeId::AddConstructor (void)
   struct Maker {
     static ObjectBase * Create () {
       ObjectBase * base = new T ();
+      if (MemoryAccounting::IsEnabled ())
+        {
+          MemoryAccounting::Allocate (base, T::GetTypeId ().GetName (), sizeof (T));
+        }
       return base;
     }
   };
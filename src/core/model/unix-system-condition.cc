@@ -119,7 +119,6 @@ SystemConditionPrivate::Wait (void)
   NS_LOG_FUNCTION_NOARGS ();
 
   pthread_mutex_lock (&m_mutex);
-  m_condition = false;
   while (m_condition == false)
     {
       pthread_cond_wait (&m_cond, &m_mutex);
@@ -28,6 +28,24 @@ NS_LOG_COMPONENT_DEFINE ("WallClockSynchronizer");
 
 namespace ns3 {
 
+NS_OBJECT_ENSURE_REGISTERED (WallClockSynchronizer);
+
+TypeId
+WallClockSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WallClockSynchronizer")
+    .SetParent<Synchronizer> ()
+    .AddConstructor<WallClockSynchronizer> ()
+    .AddAttribute ("SpinInterval",
+                   "If non-zero, sleep until this long before each event is due and "
+                   "busy-wait for the rest of the delay.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WallClockSynchronizer::m_spinInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
 WallClockSynchronizer::WallClockSynchronizer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -205,7 +223,23 @@ WallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
 //
 // XXX BUGBUG Hardcoded tunable parameter below.
 //
-  if (numberJiffies > 3)
+// When a SpinInterval is set, it replaces this guess: we sleep until that
+// long before the deadline, whatever the jiffy.
+//
+  if (m_spinInterval.IsStrictlyPositive ())
+    {
+      uint64_t nsSpin = m_spinInterval.GetNanoSeconds ();
+      if (ns > nsSpin)
+        {
+          NS_LOG_INFO ("SleepWait for " << ns - nsSpin << " ns before spinning");
+          if (SleepWait (ns - nsSpin) == false)
+            {
+              NS_LOG_INFO ("SleepWait interrupted");
+              return false;
+            }
+        }
+    }
+  else if (numberJiffies > 3)
     {
       NS_LOG_INFO ("SleepWait for " << numberJiffies * m_jiffy << " ns");
       NS_LOG_INFO ("SleepWait until " << nsCurrent + numberJiffies * m_jiffy 
@@ -378,9 +412,19 @@ WallClockSynchronizer::DriftCorrect (uint64_t nsNow, uint64_t nsDelay)
 uint64_t
 WallClockSynchronizer::GetRealtime (void)
 {
+#ifdef CLOCK_MONOTONIC
+//
+// Prefer a clock which does not jump when the system time is set, and
+// which has a better resolution than gettimeofday.
+//
+  struct timespec tsNow;
+  clock_gettime (CLOCK_MONOTONIC, &tsNow);
+  return tsNow.tv_sec * NS_PER_SEC + tsNow.tv_nsec;
+#else
   struct timeval tvNow;
   gettimeofday (&tvNow, NULL);
   return TimevalToNs (&tvNow);
+#endif
 }
 
 uint64_t
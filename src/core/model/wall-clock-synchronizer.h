@@ -21,6 +21,7 @@
 
 #include "system-condition.h"
 #include "synchronizer.h"
+#include "nstime.h"
 
 namespace ns3 {
 
@@ -58,10 +59,18 @@ namespace ns3 {
  * Nanosleep takes a struct timespec as an input so we have to deal with
  * conversion between Time and struct timespec here.  They are both 
  * interpreted as elapsed times.
+ *
+ * The operating system usually wakes a sleeping process tens of
+ * microseconds late.  When the SpinInterval attribute is set, the
+ * synchronizer only sleeps until that long before the event is due and
+ * busy-waits on the monotonic clock for the rest, trading CPU time for
+ * timing accuracy.
  */
 class WallClockSynchronizer : public Synchronizer
 {
 public:
+  static TypeId GetTypeId (void);
+
   WallClockSynchronizer ();
   virtual ~WallClockSynchronizer ();
 
@@ -187,6 +196,7 @@ protected:
   uint64_t m_realtimeTick;
   uint64_t m_jiffy;
   uint64_t m_nsEventStart;
+  Time m_spinInterval;
 
   SystemCondition m_condition;
 };
@@ -606,6 +606,162 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+// ===========================================================================
+// Test for operations applied together with Config::Batch
+// ===========================================================================
+class BatchConfigTestCase : public TestCase
+{
+public:
+  BatchConfigTestCase ();
+  virtual ~BatchConfigTestCase () {}
+
+  void Trace (int16_t oldValue, int16_t newValue) { m_count++; }
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue) { m_path = path; }
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_count;
+  std::string m_path;
+};
+
+BatchConfigTestCase::BatchConfigTestCase ()
+  : TestCase ("Check that a batch of operations behaves like the same Config calls")
+{
+}
+
+void
+BatchConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (objects.back ());
+    }
+
+  Config::Batch batch;
+  batch.Set ("/NodesA/*/A", IntegerValue (1));
+  batch.Set ("/NodesA/[1-2]/B", IntegerValue (2));
+  batch.ConnectWithoutContext ("/NodesA/0|3/Source", MakeCallback (&BatchConfigTestCase::Trace, this));
+  batch.Connect ("/NodesA/2/Source", MakeCallback (&BatchConfigTestCase::TraceWithPath, this));
+  batch.Apply ();
+
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      objects[i]->GetAttribute ("A", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), 1, "Object " << i << " should have A set");
+      objects[i]->GetAttribute ("B", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), ((i == 1 || i == 2) ? 2 : 9), "Wrong B on object " << i);
+    }
+
+  m_count = 0;
+  m_path = "";
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      objects[i]->SetAttribute ("Source", IntegerValue (i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_count, 2, "Objects 0 and 3 should have fired");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodesA/2/Source", "Object 2 did not provide expected context");
+
+  // a batch forgets its operations once applied
+  batch.Apply ();
+  m_count = 0;
+  objects[0]->SetAttribute ("Source", IntegerValue (10));
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "The sink should have been connected once");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
+// ===========================================================================
+// An object with a large container which counts the items it is asked for
+// ===========================================================================
+class ConfigCountingObject : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  void AddItem (Ptr<ConfigTestObject> item) { m_items.push_back (item); }
+  uint32_t GetItemN (void) const { return m_items.size (); }
+  Ptr<ConfigTestObject> GetItem (uint32_t i) const { m_gets++; return m_items[i]; }
+
+  mutable uint32_t m_gets;
+
+private:
+  std::vector<Ptr<ConfigTestObject> > m_items;
+};
+
+TypeId
+ConfigCountingObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ConfigCountingObject")
+    .SetParent<Object> ()
+    .AddAttribute ("Items", "",
+                   ObjectVectorValue (),
+                   MakeObjectVectorAccessor (&ConfigCountingObject::GetItem,
+                                             &ConfigCountingObject::GetItemN),
+                   MakeObjectVectorChecker<ConfigTestObject> ())
+  ;
+  return tid;
+}
+
+// ===========================================================================
+// Test that paths which name a few items of a container look them up
+// directly instead of walking the container
+// ===========================================================================
+class IndexConfigTestCase : public TestCase
+{
+public:
+  IndexConfigTestCase ();
+  virtual ~IndexConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+IndexConfigTestCase::IndexConfigTestCase ()
+  : TestCase ("Check that indexed paths do not walk the whole container")
+{
+}
+
+void
+IndexConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigCountingObject> root = CreateObject<ConfigCountingObject> ();
+  std::vector<Ptr<ConfigTestObject> > items;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      items.push_back (CreateObject<ConfigTestObject> ());
+      root->AddItem (items.back ());
+    }
+  Config::RegisterRootNamespaceObject (root);
+
+  root->m_gets = 0;
+  Config::MatchContainer matches = Config::LookupMatches ("/Items/5");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "One item should match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (0), items[5], "Wrong item");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (0), "/Items/5/", "Wrong path");
+  NS_TEST_EXPECT_MSG_EQ (root->m_gets, 1, "Only the item named should be looked up");
+
+  root->m_gets = 0;
+  matches = Config::LookupMatches ("/Items/7|[3-4]|500");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Three items should match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (0), items[3], "Items should match in order");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (1), items[4], "Items should match in order");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (2), items[7], "Items should match in order");
+  NS_TEST_EXPECT_MSG_EQ (root->m_gets, 3, "Only the items named should be looked up");
+
+  root->m_gets = 0;
+  matches = Config::LookupMatches ("/Items/*");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 100, "All the items should match");
+  NS_TEST_EXPECT_MSG_EQ (root->m_gets, 100, "A wildcard walks the container");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -621,6 +777,8 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new RootNamespaceConfigTestCase);
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
+  AddTestCase (new BatchConfigTestCase);
+  AddTestCase (new IndexConfigTestCase);
 }
 
 static ConfigTestSuite configTestSuite;
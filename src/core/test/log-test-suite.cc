@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("LogBinaryTest");
+
+namespace ns3 {
+
+class LogBinaryTestCase : public TestCase
+{
+public:
+  LogBinaryTestCase ();
+  virtual void DoRun (void);
+  void Log (uint32_t value);
+};
+
+LogBinaryTestCase::LogBinaryTestCase ()
+  : TestCase ("Check that binary log records decode to the text output")
+{
+}
+
+void
+LogBinaryTestCase::Log (uint32_t value)
+{
+  NS_LOG_FUNCTION (this << value);
+  NS_LOG_INFO ("value " << value);
+}
+
+void
+LogBinaryTestCase::DoRun (void)
+{
+#ifdef NS3_LOG_ENABLE
+  std::string filename = CreateTempDirFilename ("binary.log");
+  LogComponentEnable ("LogBinaryTest", LOG_LEVEL_FUNCTION);
+  LogBinaryEnable (filename);
+  Simulator::ScheduleWithContext (3, Seconds (1.5), &LogBinaryTestCase::Log, this, 42);
+  Simulator::Run ();
+  LogBinaryDisable ();
+  LogComponentDisable ("LogBinaryTest", LOG_LEVEL_ALL);
+  Simulator::Destroy ();
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  LogBinaryDecode (is, os);
+  std::ostringstream expected;
+  expected << "1.5s 3 LogBinaryTest:Log(" << this << ", 42)" << std::endl
+           << "1.5s 3 LogBinaryTest:Log(): value 42" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (os.str (), expected.str (), "Decoded log differs");
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+class LogBinaryThreadsTestCase : public TestCase
+{
+public:
+  LogBinaryThreadsTestCase ();
+  virtual void DoRun (void);
+  static void Log (char thread);
+};
+
+LogBinaryThreadsTestCase::LogBinaryThreadsTestCase ()
+  : TestCase ("Check that threads log whole binary records")
+{
+}
+
+void
+LogBinaryThreadsTestCase::Log (char thread)
+{
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      NS_LOG_INFO (thread << " " << i);
+    }
+}
+
+void
+LogBinaryThreadsTestCase::DoRun (void)
+{
+#ifdef NS3_LOG_ENABLE
+  std::string filename = CreateTempDirFilename ("threads.log");
+  LogComponentEnable ("LogBinaryTest", LOG_LEVEL_INFO);
+  LogBinaryEnable (filename);
+  Ptr<SystemThread> a = Create<SystemThread> (MakeBoundCallback (&LogBinaryThreadsTestCase::Log, 'a'));
+  Ptr<SystemThread> b = Create<SystemThread> (MakeBoundCallback (&LogBinaryThreadsTestCase::Log, 'b'));
+  a->Start ();
+  b->Start ();
+  a->Join ();
+  b->Join ();
+  LogBinaryDisable ();
+  LogComponentDisable ("LogBinaryTest", LOG_LEVEL_ALL);
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  LogBinaryDecode (is, os);
+  std::istringstream lines (os.str ());
+  std::string line;
+  uint32_t next[2] = { 0, 0 };
+  while (std::getline (lines, line))
+    {
+      std::istringstream fields (line.substr (line.find (": ") + 2));
+      char thread;
+      uint32_t i;
+      fields >> thread >> i;
+      NS_TEST_ASSERT_MSG_EQ (line.substr (0, line.find (": ")), "LogBinaryTest:Log()", "Corrupted record " << line);
+      NS_TEST_ASSERT_MSG_EQ (i, next[thread - 'a'], "Record of thread " << thread << " lost");
+      next[thread - 'a']++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (next[0], 1000, "Records of thread a lost");
+  NS_TEST_EXPECT_MSG_EQ (next[1], 1000, "Records of thread b lost");
+#endif
+}
+#endif /* HAVE_PTHREAD_H */
+
+static class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ()
+    : TestSuite ("log", UNIT)
+  {
+    AddTestCase (new LogBinaryTestCase ());
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new LogBinaryThreadsTestCase ());
+#endif
+  }
+} g_logTestSuite;
+
+} // namespace ns3
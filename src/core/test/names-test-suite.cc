@@ -371,10 +371,18 @@ BasicRenameTestCase::DoRun (void)
   found = Names::FindName (childOfObjectOne);
   NS_TEST_ASSERT_MSG_EQ (found, "Child", "Could not Names::Add and Names::FindName a child Object");
 
+  Ptr<TestObject> foundObject = Names::Find<TestObject> ("/Names/New Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (foundObject, childOfObjectOne, "Could not find a child Object by path after renaming its parent");
+  foundObject = Names::Find<TestObject> ("/Names/Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (foundObject, 0, "Unexpectedly found a child Object under the old name of its parent");
+
   Names::Rename (objectOne, "Child", "New Child");
 
   found = Names::FindName (childOfObjectOne);
   NS_TEST_ASSERT_MSG_EQ (found, "New Child", "Could not Names::Rename a child Object");
+
+  foundObject = Names::Find<TestObject> ("New Name/New Child");
+  NS_TEST_ASSERT_MSG_EQ (foundObject, childOfObjectOne, "Could not find a renamed child Object by path");
 }
 
 // ===========================================================================
@@ -22,6 +22,10 @@
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
 #include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/memory-accounting.h"
+#include <stdlib.h>
 
 namespace {
 
@@ -57,6 +61,40 @@ public:
   }
 };
 
+class ConstructBase : public ns3::Object
+{
+public:
+  static ns3::TypeId GetTypeId (void) {
+    static ns3::TypeId tid = ns3::TypeId ("ConstructBase")
+      .SetParent (Object::GetTypeId ())
+      .HideFromDocumentation ()
+      .AddConstructor<ConstructBase> ()
+      .AddAttribute ("Base", "A base attribute",
+                     ns3::UintegerValue (1),
+                     ns3::MakeUintegerAccessor (&ConstructBase::m_base),
+                     ns3::MakeUintegerChecker<uint32_t> ());
+    return tid;
+  }
+  uint32_t m_base;
+};
+
+class ConstructDerived : public ConstructBase
+{
+public:
+  static ns3::TypeId GetTypeId (void) {
+    static ns3::TypeId tid = ns3::TypeId ("ConstructDerived")
+      .SetParent (ConstructBase::GetTypeId ())
+      .HideFromDocumentation ()
+      .AddConstructor<ConstructDerived> ()
+      .AddAttribute ("Derived", "A derived attribute",
+                     ns3::UintegerValue (2),
+                     ns3::MakeUintegerAccessor (&ConstructDerived::m_derived),
+                     ns3::MakeUintegerChecker<uint32_t> ());
+    return tid;
+  }
+  uint32_t m_derived;
+};
+
 class BaseB : public ns3::Object
 {
 public:
@@ -407,6 +445,146 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+// ===========================================================================
+// Test case to make sure that construction picks attribute values from the
+// factory, the environment and the defaults, in that order, also once the
+// attributes of a type have been cached
+// ===========================================================================
+class ConstructAttributesTestCase : public TestCase
+{
+public:
+  ConstructAttributesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ConstructAttributesTestCase::ConstructAttributesTestCase ()
+  : TestCase ("Check attribute initialization at construction")
+{
+}
+
+void
+ConstructAttributesTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (ConstructDerived::GetTypeId ());
+  Ptr<ConstructDerived> a = factory.Create<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 1, "Parent attribute not initialized");
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 2, "Attribute not initialized");
+
+  factory.Set ("Base", UintegerValue (10));
+  a = factory.Create<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 10, "Factory value not used");
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 2, "Attribute not initialized");
+
+  Config::SetDefault ("ConstructDerived::Derived", UintegerValue (20));
+  a = factory.Create<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 20, "New default not used");
+  Config::SetDefault ("ConstructDerived::Derived", UintegerValue (2));
+
+  setenv ("NS_ATTRIBUTE_DEFAULT", "ConstructBase::Base=30;ConstructDerived::Derived=foo;ConstructDerived::Derived=40", 1);
+  a = CreateObject<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 30, "Environment value not used");
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 40, "First valid environment value not used");
+  a = factory.Create<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 10, "Factory value should override the environment");
+  unsetenv ("NS_ATTRIBUTE_DEFAULT");
+
+  a = CreateObject<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 1, "Environment value still used once unset");
+}
+
+// ===========================================================================
+// Test case to make sure that the validated default cached for an attribute
+// is refreshed when Config::SetDefault or Config::Reset changes the default
+// ===========================================================================
+class ConstructDefaultsTestCase : public TestCase
+{
+public:
+  ConstructDefaultsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ConstructDefaultsTestCase::ConstructDefaultsTestCase ()
+  : TestCase ("Check that construction follows changes of the defaults")
+{
+}
+
+void
+ConstructDefaultsTestCase::DoRun (void)
+{
+  Ptr<ConstructDerived> a = CreateObject<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 1, "Parent attribute not initialized");
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 2, "Attribute not initialized");
+
+  Config::SetDefault ("ConstructBase::Base", UintegerValue (5));
+  Config::SetDefault ("ConstructDerived::Derived", UintegerValue (6));
+  a = CreateObject<ConstructDerived> ();
+  NS_TEST_EXPECT_MSG_EQ (a->m_base, 5, "New parent default not used");
+  NS_TEST_EXPECT_MSG_EQ (a->m_derived, 6, "New default not used");
+
+  Config::SetDefault ("ConstructBase::Base", UintegerValue (1));
+  Config::SetDefault ("ConstructDerived::Derived", UintegerValue (2));
+  a = CreateObject<ConstructDerived> ();
+  NS_TEST_ASSERT_MSG_EQ (a->m_base, 1, "Parent default not restored");
+  NS_TEST_ASSERT_MSG_EQ (a->m_derived, 2, "Default not restored");
+}
+
+// ===========================================================================
+// Test case to make sure that objects created by CreateObject, CopyObject
+// and ObjectFactory are accounted for while they are alive
+// ===========================================================================
+class MemoryAccountingTestCase : public TestCase
+{
+public:
+  MemoryAccountingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MemoryAccountingTestCase::MemoryAccountingTestCase ()
+  : TestCase ("Check memory accounting of objects")
+{
+}
+
+void
+MemoryAccountingTestCase::DoRun (void)
+{
+  MemoryAccounting::Enable ();
+  Ptr<ConstructBase> a = CreateObject<ConstructBase> ();
+  Ptr<ConstructBase> b = CopyObject<ConstructBase> (a);
+  ObjectFactory factory;
+  factory.SetTypeId (ConstructDerived::GetTypeId ());
+  Ptr<ConstructDerived> c = factory.Create<ConstructDerived> ();
+
+  MemoryAccounting::Usage usage = MemoryAccounting::GetUsage ("ConstructBase");
+  NS_TEST_EXPECT_MSG_EQ (usage.count, 2, "Created and copied objects should be counted");
+  NS_TEST_EXPECT_MSG_EQ (usage.bytes, 2 * sizeof (ConstructBase), "Wrong live bytes");
+  usage = MemoryAccounting::GetUsage ("ConstructDerived");
+  NS_TEST_EXPECT_MSG_EQ (usage.count, 1, "Objects created by a factory should be counted");
+  NS_TEST_EXPECT_MSG_EQ (usage.bytes, sizeof (ConstructDerived), "Wrong live bytes");
+  NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetContextUsage (0xffffffff).count, 3,
+                         "Objects created outside of any event have no context");
+  MemoryAccounting::SetContext (static_cast<ObjectBase *> (PeekPointer (c)), 3);
+  NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetContextUsage (3).bytes, sizeof (ConstructDerived),
+                         "The object should have moved to its new context");
+  NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetContextUsage (0xffffffff).count, 2,
+                         "The object should have left its old context");
+
+  a = 0;
+  b = 0;
+  usage = MemoryAccounting::GetUsage ("ConstructBase");
+  NS_TEST_EXPECT_MSG_EQ (usage.count, 0, "Destroyed objects should not be counted");
+  NS_TEST_EXPECT_MSG_EQ (usage.peakBytes, 2 * sizeof (ConstructBase), "Peak should be kept");
+  NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetTotalUsage ().bytes, sizeof (ConstructDerived), "Wrong total");
+  MemoryAccounting::Disable ();
+  NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetTotalUsage ().count, 0, "Disable should forget allocations");
+}
+
 // ===========================================================================
 // The Test Suite that glues the Test Cases together.
 // ===========================================================================
@@ -422,6 +600,9 @@ ObjectTestSuite::ObjectTestSuite ()
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
   AddTestCase (new ObjectFactoryTestCase);
+  AddTestCase (new ConstructAttributesTestCase);
+  AddTestCase (new ConstructDefaultsTestCase);
+  AddTestCase (new MemoryAccountingTestCase);
 }
 
 static ObjectTestSuite objectTestSuite;
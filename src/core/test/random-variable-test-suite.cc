@@ -129,6 +129,54 @@ RandomNumberSerializationTestCase::DoRun (void)
                          "Deserialize and Serialize \"Normal:0.1:0.2:0.15\" mismatch");
 }
 
+class RandomNumberBulkTestCase : public TestCase
+{
+public:
+  RandomNumberBulkTestCase ();
+  virtual ~RandomNumberBulkTestCase ()
+  {
+  }
+
+private:
+  void Check (RandomVariable variable, std::string name);
+  virtual void DoRun (void);
+};
+
+RandomNumberBulkTestCase::RandomNumberBulkTestCase ()
+  : TestCase ("Check that GetValues matches GetValue")
+{
+}
+
+void
+RandomNumberBulkTestCase::Check (RandomVariable variable, std::string name)
+{
+  // the first draw creates the generator, which the copy then shares.
+  // Copies of normal variables drop the second value of a pair, so use it
+  // up before copying.
+  variable.GetValue ();
+  variable.GetValue ();
+  RandomVariable copy = variable;
+  const uint32_t N = 1000;
+  double values[N];
+  copy.GetValues (values, N);
+  for (uint32_t i = 0; i < N; ++i)
+    {
+      double expected = variable.GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (values[i], expected, name << " value " << i << " differs");
+    }
+  NS_TEST_ASSERT_MSG_EQ (copy.GetValue (), variable.GetValue (), name << " stream differs after GetValues");
+}
+
+void
+RandomNumberBulkTestCase::DoRun (void)
+{
+  Check (UniformVariable (2.0, 5.0), "Uniform");
+  Check (ExponentialVariable (3.0), "Exponential");
+  Check (ExponentialVariable (3.0, 4.0), "Bounded exponential");
+  Check (NormalVariable (1.0, 2.0), "Normal");
+  Check (ParetoVariable (1.0, 1.5), "Pareto");
+}
+
 class BasicRandomNumberTestSuite : public TestSuite
 {
 public:
@@ -140,6 +188,7 @@ BasicRandomNumberTestSuite::BasicRandomNumberTestSuite ()
 {
   AddTestCase (new BasicRandomNumberTestCase);
   AddTestCase (new RandomNumberSerializationTestCase);
+  AddTestCase (new RandomNumberBulkTestCase);
 }
 
 static BasicRandomNumberTestSuite BasicRandomNumberTestSuite;
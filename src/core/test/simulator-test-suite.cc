@@ -23,6 +23,19 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/config.h"
+#include "ns3/checkpoint.h"
+#include "ns3/async-writer.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_RT
+#include "ns3/realtime-simulator-impl.h"
+#endif
+#if defined (HAVE_SYS_WAIT_H) || defined (HAVE_RT)
+#include <unistd.h>
+#endif
 
 namespace ns3 {
 
@@ -459,6 +472,244 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorProfilingTestCase : public TestCase
+{
+public:
+  SimulatorProfilingTestCase ();
+  virtual void DoRun (void);
+  void Foo (void);
+};
+
+SimulatorProfilingTestCase::SimulatorProfilingTestCase ()
+  : TestCase ("Check the event counts of the simulator profiling mode")
+{
+}
+
+void
+SimulatorProfilingTestCase::Foo (void)
+{
+}
+
+void
+SimulatorProfilingTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = CreateObject<DefaultSimulatorImpl> ();
+  impl->SetAttribute ("EnableProfiling", BooleanValue (true));
+  impl->SetAttribute ("ProfilingOutput", StringValue (CreateTempDirFilename ("simulator-profile.txt")));
+  ObjectFactory factory;
+  factory.SetTypeId (MapScheduler::GetTypeId ());
+  impl->SetScheduler (factory);
+  Simulator::SetImplementation (impl);
+
+  Simulator::Schedule (Seconds (1), &SimulatorProfilingTestCase::Foo, this);
+  Simulator::ScheduleWithContext (7, Seconds (2), &SimulatorProfilingTestCase::Foo, this);
+  Simulator::ScheduleWithContext (7, Seconds (3), &SimulatorProfilingTestCase::Foo, this);
+  EventId id = Simulator::Schedule (Seconds (4), &SimulatorProfilingTestCase::Foo, this);
+  Simulator::Cancel (id);
+  Simulator::Run ();
+
+  const EventProfiler &profiler = impl->GetProfiler ();
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (), 4, "All events should be counted");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (7), 2, "Two events ran in context 7");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetCancelledCount (), 1, "One event was cancelled");
+  Simulator::Destroy ();
+}
+
+#ifdef HAVE_RT
+class SimulatorRealtimeTestCase : public TestCase
+{
+public:
+  SimulatorRealtimeTestCase ();
+  virtual void DoRun (void);
+  void Foo (void);
+  void Busy (void);
+  void Order (uint32_t i);
+  void Lateness (Time lateness);
+  std::vector<Time> m_lateness;
+  std::vector<uint32_t> m_order;
+};
+
+SimulatorRealtimeTestCase::SimulatorRealtimeTestCase ()
+  : TestCase ("Check the spin wait and batch window of the realtime simulator")
+{
+}
+
+void
+SimulatorRealtimeTestCase::Foo (void)
+{
+}
+
+void
+SimulatorRealtimeTestCase::Busy (void)
+{
+  // fall behind real time
+  usleep (20000);
+}
+
+void
+SimulatorRealtimeTestCase::Order (uint32_t i)
+{
+  m_order.push_back (i);
+}
+
+void
+SimulatorRealtimeTestCase::Lateness (Time lateness)
+{
+  m_lateness.push_back (lateness);
+}
+
+void
+SimulatorRealtimeTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MapScheduler::GetTypeId ());
+
+  // spinning until the deadline never starts an event early
+  Config::SetDefault ("ns3::WallClockSynchronizer::SpinInterval", TimeValue (MicroSeconds (500)));
+  Ptr<RealtimeSimulatorImpl> impl = CreateObject<RealtimeSimulatorImpl> ();
+  Config::SetDefault ("ns3::WallClockSynchronizer::SpinInterval", TimeValue (Seconds (0)));
+  impl->SetScheduler (factory);
+  impl->TraceConnectWithoutContext ("EventLateness", MakeCallback (&SimulatorRealtimeTestCase::Lateness, this));
+  Simulator::SetImplementation (impl);
+  for (uint32_t i = 1; i <= 5; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (2 * i), &SimulatorRealtimeTestCase::Foo, this);
+    }
+  // the realtime simulator waits for external events until it is stopped
+  Simulator::Stop (MilliSeconds (11));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_lateness.size (), 6, "Every event, and the stop, should report its lateness");
+  for (uint32_t i = 0; i < m_lateness.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_lateness[i].IsPositive (), true, "Event " << i << " started early");
+    }
+
+  // events within the batch window do not wait
+  m_lateness.clear ();
+  impl = CreateObject<RealtimeSimulatorImpl> ();
+  impl->SetAttribute ("BatchWindow", TimeValue (Seconds (10)));
+  impl->SetScheduler (factory);
+  impl->TraceConnectWithoutContext ("EventLateness", MakeCallback (&SimulatorRealtimeTestCase::Lateness, this));
+  Simulator::SetImplementation (impl);
+  Simulator::Schedule (Seconds (1), &SimulatorRealtimeTestCase::Foo, this);
+  Simulator::Schedule (Seconds (2), &SimulatorRealtimeTestCase::Foo, this);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_lateness.size (), 3, "Every event, and the stop, should report its lateness");
+  NS_TEST_EXPECT_MSG_LT (m_lateness[1], Seconds (-1), "Batched event should have run early");
+
+  // batched events run in order, late ones after a slow event as well as
+  // those up to the batch window ahead of real time
+  m_lateness.clear ();
+  impl = CreateObject<RealtimeSimulatorImpl> ();
+  impl->SetAttribute ("BatchWindow", TimeValue (MilliSeconds (5)));
+  impl->SetScheduler (factory);
+  impl->TraceConnectWithoutContext ("EventLateness", MakeCallback (&SimulatorRealtimeTestCase::Lateness, this));
+  Simulator::SetImplementation (impl);
+  Simulator::Schedule (MilliSeconds (1), &SimulatorRealtimeTestCase::Busy, this);
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (2 + i), &SimulatorRealtimeTestCase::Order, this, i);
+    }
+  for (uint32_t i = 5; i < 8; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (25 + i), &SimulatorRealtimeTestCase::Order, this, i);
+    }
+  Simulator::Stop (MilliSeconds (40));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), 8, "Every batched event should run");
+  for (uint32_t i = 0; i < m_order.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], i, "Batched events should run in order");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_lateness.size (), 10, "Every event, and the stop, should report its lateness");
+  for (uint32_t i = 1; i <= 5; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_lateness[i].IsPositive (), true, "Event " << i << " after the slow event should be late");
+    }
+  for (uint32_t i = 7; i <= 8; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_lateness[i] >= MilliSeconds (-5)), true, "Event " << i << " ran before the batch window");
+    }
+}
+#endif /* HAVE_RT */
+
+#ifdef HAVE_SYS_WAIT_H
+class SimulatorCheckpointTestCase : public TestCase
+{
+public:
+  SimulatorCheckpointTestCase ();
+  virtual void DoRun (void);
+  void Tick (void);
+  void Setup (uint32_t variant);
+  void Consume (const uint8_t *data, uint32_t size);
+  uint32_t m_step;
+  uint32_t m_sum;
+  uint32_t m_records;
+};
+
+SimulatorCheckpointTestCase::SimulatorCheckpointTestCase ()
+  : TestCase ("Check that variants forked at a checkpoint resume from its state")
+{
+}
+
+void
+SimulatorCheckpointTestCase::Tick (void)
+{
+  m_sum += m_step;
+}
+
+void
+SimulatorCheckpointTestCase::Setup (uint32_t variant)
+{
+  m_step = variant + 1;
+}
+
+void
+SimulatorCheckpointTestCase::Consume (const uint8_t *data, uint32_t size)
+{
+  m_records++;
+}
+
+void
+SimulatorCheckpointTestCase::DoRun (void)
+{
+  m_step = 1;
+  m_sum = 0;
+  m_records = 0;
+  // the writer must still consume records after the checkpoint
+  AsyncWriter *writer = new AsyncWriter (4096, MakeCallback (&SimulatorCheckpointTestCase::Consume, this));
+  uint8_t record[100] = { 0 };
+  writer->Write (record, sizeof (record));
+  for (uint32_t i = 1; i <= 10; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulatorCheckpointTestCase::Tick, this);
+    }
+  Checkpoint::Schedule (Seconds (4.5), 3, MakeCallback (&SimulatorCheckpointTestCase::Setup, this), 2);
+  Simulator::Run ();
+  if (Checkpoint::IsVariant ())
+    {
+      // four ticks before the checkpoint, six with the step of the variant
+      bool ok = m_sum == 4 + 6 * (Checkpoint::GetVariant () + 1);
+      for (uint32_t i = 0; i < 100; ++i)
+        {
+          writer->Write (record, sizeof (record));
+        }
+      writer->Drain ();
+      ok = ok && m_records == 101;
+      _exit (ok ? 0 : 1);
+    }
+  delete writer;
+  NS_TEST_EXPECT_MSG_EQ (m_records, 1, "The records written before the checkpoint should be consumed");
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 4, "The parent should stop at the checkpoint");
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::GetFailedCount (), 0, "Every variant should resume from the checkpoint");
+}
+#endif /* HAVE_SYS_WAIT_H */
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,6 +726,13 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory));
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory));
+    AddTestCase (new SimulatorProfilingTestCase ());
+#ifdef HAVE_RT
+    AddTestCase (new SimulatorRealtimeTestCase ());
+#endif
+#ifdef HAVE_SYS_WAIT_H
+    AddTestCase (new SimulatorCheckpointTestCase ());
+#endif
   }
 } g_simulatorTestSuite;
 
@@ -21,6 +21,7 @@
  */
 #include "ns3/nstime.h"
 #include "ns3/test.h"
+#include "ns3/core-config.h"
 
 namespace ns3 {
 
@@ -133,14 +134,50 @@ TimesWithSignsTestCase::DoTeardown (void)
 {
 }
 
+class TimeConversionsTestCase : public TestCase
+{
+public:
+  TimeConversionsTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeConversionsTestCase::TimeConversionsTestCase ()
+  : TestCase ("Check integer conversions between units")
+{
+}
+
+void
+TimeConversionsTestCase::DoRun (void)
+{
+  // these hold for any resolution of a nanosecond or finer
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (3).GetNanoSeconds (), 3000000, "3ms in ns");
+  NS_TEST_ASSERT_MSG_EQ (NanoSeconds (3000000).GetMilliSeconds (), 3, "3000000ns in ms");
+  NS_TEST_ASSERT_MSG_EQ (NanoSeconds (3999999).GetMilliSeconds (), 3, "3999999ns in ms");
+  NS_TEST_ASSERT_MSG_EQ (MicroSeconds (7).GetMicroSeconds (), 7, "7us in us");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (2.0).GetMicroSeconds (), 2000000, "2s in us");
+  NS_TEST_ASSERT_MSG_EQ ((MilliSeconds (1) - MilliSeconds (3)).GetMicroSeconds (), -2000, "-2ms in us");
+  NS_TEST_ASSERT_MSG_EQ ((MilliSeconds (1) - MilliSeconds (3)).GetMilliSeconds (), -2, "-2ms in ms");
+  NS_TEST_ASSERT_MSG_EQ (TimeStep (1).GetFemtoSeconds (), FemtoSeconds (TimeStep (1).GetFemtoSeconds ()).GetFemtoSeconds (),
+                         "One step round trip in fs");
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
   TimeTestSuite ()
     : TestSuite ("time", UNIT)
   {
+#ifdef NS3_TIME_RESOLUTION
+    AddTestCase (new TimeSimpleTestCase ((enum Time::Unit)NS3_TIME_RESOLUTION));
+#else
     AddTestCase (new TimeSimpleTestCase (Time::US));
+#endif
     AddTestCase (new TimesWithSignsTestCase ());
+    // the conversions only hold at a resolution of Time::NS or finer
+#if !defined (NS3_TIME_RESOLUTION) || NS3_TIME_RESOLUTION >= 3
+    AddTestCase (new TimeConversionsTestCase ());
+#endif
   }
 } g_timeTestSuite;
 
@@ -21,6 +21,7 @@
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/nstime.h"
+#include "ns3/global-value.h"
 
 namespace {
 void bari (int)
@@ -208,6 +209,85 @@ TimerTemplateTestCase::DoTeardown (void)
   Simulator::Destroy ();
 }
 
+class TimerWheelTestCase : public TestCase
+{
+public:
+  TimerWheelTestCase ();
+  virtual void DoRun (void);
+  void Expire (int id);
+  void Rearm (Timer *timer);
+
+  std::vector<std::pair<int, Time> > m_expired;
+};
+
+TimerWheelTestCase::TimerWheelTestCase ()
+  : TestCase ("Check that timers on the timer wheel expire on time")
+{
+}
+
+void
+TimerWheelTestCase::Expire (int id)
+{
+  m_expired.push_back (std::make_pair (id, Simulator::Now ()));
+}
+
+void
+TimerWheelTestCase::Rearm (Timer *timer)
+{
+  timer->Cancel ();
+  timer->Schedule ();
+}
+
+void
+TimerWheelTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("TimerWheelSlot", TimeValue (MilliSeconds (100)));
+  Timer rearmed (Timer::CANCEL_ON_DESTROY);
+  Timer cancelled (Timer::CANCEL_ON_DESTROY);
+  Timer suspended (Timer::CANCEL_ON_DESTROY);
+  Timer close (Timer::CANCEL_ON_DESTROY);
+  GlobalValue::Bind ("TimerWheelSlot", TimeValue (Seconds (0)));
+
+  rearmed.SetFunction (&TimerWheelTestCase::Expire, this);
+  rearmed.SetArguments (0);
+  rearmed.SetDelay (MilliSeconds (250));
+  rearmed.Schedule ();
+  for (uint32_t i = 1; i <= 10; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (10 * i), &TimerWheelTestCase::Rearm, this, &rearmed);
+    }
+
+  cancelled.SetFunction (&TimerWheelTestCase::Expire, this);
+  cancelled.SetArguments (1);
+  cancelled.Schedule (MilliSeconds (500));
+  Simulator::Schedule (MilliSeconds (50), &Timer::Cancel, &cancelled);
+
+  suspended.SetFunction (&TimerWheelTestCase::Expire, this);
+  suspended.SetArguments (2);
+  suspended.Schedule (MilliSeconds (420));
+  NS_TEST_EXPECT_MSG_EQ (suspended.IsRunning (), true, "A timer on the wheel is running");
+  NS_TEST_EXPECT_MSG_EQ (suspended.GetDelayLeft (), MilliSeconds (420), "Wrong delay left on the wheel");
+  Simulator::Schedule (MilliSeconds (20), &Timer::Suspend, &suspended);
+  Simulator::Schedule (MilliSeconds (120), &Timer::Resume, &suspended);
+
+  close.SetFunction (&TimerWheelTestCase::Expire, this);
+  close.SetArguments (3);
+  close.Schedule (MilliSeconds (30));
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 3, "The cancelled timer should not expire");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].first, 3, "The timer in the current slot is scheduled directly");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].second, MilliSeconds (30), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1].first, 0, "Wrong expiration order");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1].second, MilliSeconds (350), "The last re-arm should set the expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[2].first, 2, "Wrong expiration order");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[2].second, MilliSeconds (520), "Suspend should keep the delay left");
+  NS_TEST_EXPECT_MSG_EQ (rearmed.IsExpired (), true, "The timer should have expired");
+
+  Simulator::Destroy ();
+}
+
 static class TimerTestSuite : public TestSuite
 {
 public:
@@ -216,6 +296,7 @@ public:
   {
     AddTestCase (new TimerStateTestCase ());
     AddTestCase (new TimerTemplateTestCase ());
+    AddTestCase (new TimerWheelTestCase ());
   }
 } g_timerTestSuite;
 
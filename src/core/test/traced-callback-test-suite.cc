@@ -62,6 +62,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "A new TracedCallback should be empty");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -70,6 +71,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Connected TracedCallback should not be empty");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -95,6 +97,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, false, "Callback CbOne unexpectedly called");
   NS_TEST_ASSERT_MSG_EQ (m_two, false, "Callback CbTwo unexpectedly called");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "Disconnected TracedCallback should be empty");
 
   //
   // If we connect them back up, then both callbacks should be called.
@@ -108,6 +111,104 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ReentrantTracedCallbackTestCase : public TestCase
+{
+public:
+  ReentrantTracedCallbackTestCase ();
+  virtual ~ReentrantTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbConnect (uint32_t a);
+  void CbCount (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_count;
+};
+
+ReentrantTracedCallbackTestCase::ReentrantTracedCallbackTestCase ()
+  : TestCase ("Check that a callback can connect callbacks while the trace is fired")
+{
+}
+
+void
+ReentrantTracedCallbackTestCase::CbConnect (uint32_t a)
+{
+  // enough callbacks to make the storage grow while it is walked
+  for (uint32_t i = 0; i < 16; ++i)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbCount, this));
+    }
+}
+
+void
+ReentrantTracedCallbackTestCase::CbCount (uint32_t a)
+{
+  m_count += a;
+}
+
+void
+ReentrantTracedCallbackTestCase::DoRun (void)
+{
+  m_count = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&ReentrantTracedCallbackTestCase::CbConnect, this));
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 16, "Callbacks connected by a callback should be called");
+}
+
+class DisconnectTracedCallbackTestCase : public TestCase
+{
+public:
+  DisconnectTracedCallbackTestCase ();
+  virtual ~DisconnectTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbDisconnect (uint32_t a);
+  void CbCount (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_disconnect;
+  uint32_t m_count;
+};
+
+DisconnectTracedCallbackTestCase::DisconnectTracedCallbackTestCase ()
+  : TestCase ("Check that a callback can disconnect itself while the trace is fired")
+{
+}
+
+void
+DisconnectTracedCallbackTestCase::CbDisconnect (uint32_t a)
+{
+  m_disconnect += a;
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbDisconnect, this));
+}
+
+void
+DisconnectTracedCallbackTestCase::CbCount (uint32_t a)
+{
+  m_count += a;
+}
+
+void
+DisconnectTracedCallbackTestCase::DoRun (void)
+{
+  m_disconnect = 0;
+  m_count = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbDisconnect, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbCount, this));
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_disconnect, 1, "Callback not called before it disconnects");
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Callback after the disconnected one not called");
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_disconnect, 1, "Disconnected callback still called");
+  NS_TEST_ASSERT_MSG_EQ (m_count, 2, "Callback left not called");
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbCount, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected callbacks not removed");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +219,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase);
+  AddTestCase (new ReentrantTracedCallbackTestCase);
+  AddTestCase (new DisconnectTracedCallbackTestCase);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -118,8 +118,11 @@ Ipv4FlowClassifier::Classify (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
     {
     case UDP_PROT_NUMBER:
       {
-        UdpHeader udpHeader;
-        ipPayload->PeekHeader (udpHeader);
+        UdpHeaderView udpHeader (*ipPayload);
+        if (!udpHeader.IsValid ())
+          {
+            return false;
+          }
         tuple.sourcePort = udpHeader.GetSourcePort ();
         tuple.destinationPort = udpHeader.GetDestinationPort ();
       }
@@ -127,8 +130,11 @@ Ipv4FlowClassifier::Classify (const Ipv4Header &ipHeader, Ptr<const Packet> ipPa
 
     case TCP_PROT_NUMBER:
       {
-        TcpHeader tcpHeader;
-        ipPayload->PeekHeader (tcpHeader);
+        TcpHeaderView tcpHeader (*ipPayload);
+        if (!tcpHeader.IsValid ())
+          {
+            return false;
+          }
         tuple.sourcePort = tcpHeader.GetSourcePort ();
         tuple.destinationPort = tcpHeader.GetDestinationPort ();
       }
@@ -186,6 +186,13 @@ namespace ns3 {
 //
 #define INTERFACE_CONTEXT
 
+// whether the decoder of the binary traces prints the interface after the context
+#ifdef INTERFACE_CONTEXT
+static const bool g_printInterface = true;
+#else
+static const bool g_printInterface = false;
+#endif
+
 //
 // Things are going to work differently here with respect to trace file handling
 // than in most places because the Tx and Rx trace sources we are interested in
@@ -611,6 +618,11 @@ Ipv4L3ProtocolDropSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'd', "", interface, packet, packet->GetSize () + header.GetSerializedSize ()))
+    {
+      return;
+    }
+
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
@@ -630,6 +642,11 @@ Ipv4L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 't', "", interface, packet, packet->GetSize ()))
+    {
+      return;
+    }
+
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -647,6 +664,11 @@ Ipv4L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'r', "", interface, packet, packet->GetSize ()))
+    {
+      return;
+    }
+
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -673,6 +695,11 @@ Ipv4L3ProtocolDropSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'd', context, interface, packet, packet->GetSize () + header.GetSerializedSize (), g_printInterface))
+    {
+      return;
+    }
+
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
 #ifdef INTERFACE_CONTEXT
@@ -698,6 +725,11 @@ Ipv4L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 't', context, interface, packet, packet->GetSize (), g_printInterface))
+    {
+      return;
+    }
+
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -721,6 +753,11 @@ Ipv4L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'r', context, interface, packet, packet->GetSize (), g_printInterface))
+    {
+      return;
+    }
+
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -900,6 +937,11 @@ Ipv6L3ProtocolDropSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'd', "", interface, packet, packet->GetSize () + header.GetSerializedSize ()))
+    {
+      return;
+    }
+
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
@@ -919,6 +961,11 @@ Ipv6L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 't', "", interface, packet, packet->GetSize ()))
+    {
+      return;
+    }
+
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -936,6 +983,11 @@ Ipv6L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'r', "", interface, packet, packet->GetSize ()))
+    {
+      return;
+    }
+
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -962,6 +1014,11 @@ Ipv6L3ProtocolDropSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'd', context, interface, packet, packet->GetSize () + header.GetSerializedSize (), g_printInterface))
+    {
+      return;
+    }
+
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
 #ifdef INTERFACE_CONTEXT
@@ -987,6 +1044,11 @@ Ipv6L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 't', context, interface, packet, packet->GetSize (), g_printInterface))
+    {
+      return;
+    }
+
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -1010,6 +1072,11 @@ Ipv6L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (AsciiTraceHelper::WriteBinary (stream, 'r', context, interface, packet, packet->GetSize (), g_printInterface))
+    {
+      return;
+    }
+
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -96,14 +96,10 @@ Fq_CoDelQueue::hash(Ptr<Packet> p)
 {
   boost::hash<std::string> string_hash;
 
-  Ptr<Packet> q = p->Copy();
-
   class PppHeader ppp_hd;
 
-  q->RemoveHeader(ppp_hd);
-
-  class Ipv4Header ip_hd;
-  if (q->PeekHeader (ip_hd))
+  Ipv4HeaderView ip_hd (*p, ppp_hd.GetSerializedSize ());
+  if (ip_hd.IsValid ())
     {
       if (pcounter > m_peturbInterval)
         peturbation = psource.GetInteger(0,std::numeric_limits<std::size_t>::max());
@@ -426,4 +426,50 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Ipv4HeaderView::Ipv4HeaderView (const Packet &packet, uint32_t offset)
+  : HeaderView (packet, offset, 20)
+{
+}
+
+uint8_t
+Ipv4HeaderView::GetTos (void) const
+{
+  return ReadU8 (1);
+}
+uint16_t
+Ipv4HeaderView::GetPayloadSize (void) const
+{
+  return ReadNtohU16 (2) - GetSerializedSize ();
+}
+uint16_t
+Ipv4HeaderView::GetIdentification (void) const
+{
+  return ReadNtohU16 (4);
+}
+uint8_t
+Ipv4HeaderView::GetTtl (void) const
+{
+  return ReadU8 (8);
+}
+uint8_t
+Ipv4HeaderView::GetProtocol (void) const
+{
+  return ReadU8 (9);
+}
+Ipv4Address
+Ipv4HeaderView::GetSource (void) const
+{
+  return Ipv4Address (ReadNtohU32 (12));
+}
+Ipv4Address
+Ipv4HeaderView::GetDestination (void) const
+{
+  return Ipv4Address (ReadNtohU32 (16));
+}
+uint32_t
+Ipv4HeaderView::GetSerializedSize (void) const
+{
+  return (ReadU8 (0) & 0x0f) * 4;
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define IPV4_HEADER_H
 
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -246,6 +247,54 @@ private:
   bool m_goodChecksum;
 };
 
+/**
+ * \brief Read-only view of an IPv4 header stored in a packet
+ *
+ * Only the fixed part of the header is covered: the options cannot be
+ * read through this view.
+ */
+class Ipv4HeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet which contains the header
+   * \param offset offset of the header from the start of the packet
+   */
+  Ipv4HeaderView (const Packet &packet, uint32_t offset = 0);
+  /**
+   * \returns the TOS field of this packet.
+   */
+  uint8_t GetTos (void) const;
+  /**
+   * \returns the size of the payload in bytes
+   */
+  uint16_t GetPayloadSize (void) const;
+  /**
+   * \returns the identification field of this packet.
+   */
+  uint16_t GetIdentification (void) const;
+  /**
+   * \returns the TTL field of this packet
+   */
+  uint8_t GetTtl (void) const;
+  /**
+   * \returns the protocol field of this packet
+   */
+  uint8_t GetProtocol (void) const;
+  /**
+   * \returns the source address of this packet
+   */
+  Ipv4Address GetSource (void) const;
+  /**
+   * \returns the destination address of this packet
+   */
+  Ipv4Address GetDestination (void) const;
+  /**
+   * \returns the size of the header, options included
+   */
+  uint32_t GetSerializedSize (void) const;
+};
+
 } // namespace ns3
 
 
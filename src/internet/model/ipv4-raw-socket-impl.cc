@@ -222,9 +222,13 @@ Ipv4RawSocketImpl::SendTo (Ptr<Packet> p, uint32_t flags,
       if (!oif && src != Ipv4Address::GetAny ())
         {
           int32_t index = ipv4->GetInterfaceForAddress (src);
-          NS_ASSERT (index >= 0);
-          oif = ipv4->GetNetDevice (index);
-          NS_LOG_LOGIC ("Set index " << oif << "from source " << src);
+          // the source of an included header may be any address
+          NS_ASSERT (index >= 0 || m_iphdrincl);
+          if (index >= 0)
+            {
+              oif = ipv4->GetNetDevice (index);
+              NS_LOG_LOGIC ("Set index " << oif << "from source " << src);
+            }
         }
 
       // TBD-- we could cache the route and just check its validity
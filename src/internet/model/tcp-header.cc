@@ -305,5 +305,36 @@ uint32_t TcpHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+TcpHeaderView::TcpHeaderView (const Packet &packet, uint32_t offset)
+  : HeaderView (packet, offset, 20)
+{
+}
+
+uint16_t
+TcpHeaderView::GetSourcePort (void) const
+{
+  return ReadNtohU16 (0);
+}
+uint16_t
+TcpHeaderView::GetDestinationPort (void) const
+{
+  return ReadNtohU16 (2);
+}
+SequenceNumber32
+TcpHeaderView::GetSequenceNumber (void) const
+{
+  return SequenceNumber32 (ReadNtohU32 (4));
+}
+SequenceNumber32
+TcpHeaderView::GetAckNumber (void) const
+{
+  return SequenceNumber32 (ReadNtohU32 (8));
+}
+uint8_t
+TcpHeaderView::GetFlags (void) const
+{
+  return ReadNtohU16 (12) & 0x3f;
+}
+
 
 } // namespace ns3
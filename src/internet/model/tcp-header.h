@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/ipv4-address.h"
@@ -176,6 +177,42 @@ private:
   bool m_goodChecksum;
 };
 
+/**
+ * \brief Read-only view of a TCP header stored in a packet
+ *
+ * Only the fixed part of the header is covered: the options cannot be
+ * read through this view.
+ */
+class TcpHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet which contains the header
+   * \param offset offset of the header from the start of the packet
+   */
+  TcpHeaderView (const Packet &packet, uint32_t offset = 0);
+  /**
+   * \return The source port for this TcpHeader
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \return the destination port for this TcpHeader
+   */
+  uint16_t GetDestinationPort (void) const;
+  /**
+   * \return the sequence number for this TcpHeader
+   */
+  SequenceNumber32 GetSequenceNumber (void) const;
+  /**
+   * \return the ACK number for this TcpHeader
+   */
+  SequenceNumber32 GetAckNumber (void) const;
+  /**
+   * \return the flags for this TcpHeader
+   */
+  uint8_t GetFlags (void) const;
+};
+
 } // namespace ns3
 
 #endif /* TCP_HEADER */
@@ -209,5 +209,21 @@ UdpHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+UdpHeaderView::UdpHeaderView (const Packet &packet, uint32_t offset)
+  : HeaderView (packet, offset, 8)
+{
+}
+
+uint16_t
+UdpHeaderView::GetSourcePort (void) const
+{
+  return ReadNtohU16 (0);
+}
+uint16_t
+UdpHeaderView::GetDestinationPort (void) const
+{
+  return ReadNtohU16 (2);
+}
+
 
 } // namespace ns3
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <string>
 #include "ns3/header.h"
+#include "ns3/header-view.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 
@@ -140,6 +141,27 @@ private:
   bool m_goodChecksum;
 };
 
+/**
+ * \brief Read-only view of a UDP header stored in a packet
+ */
+class UdpHeaderView : public HeaderView
+{
+public:
+  /**
+   * \param packet the packet which contains the header
+   * \param offset offset of the header from the start of the packet
+   */
+  UdpHeaderView (const Packet &packet, uint32_t offset = 0);
+  /**
+   * \returns the source port for this UDP header
+   */
+  uint16_t GetSourcePort (void) const;
+  /**
+   * \returns the destination port for this UDP header
+   */
+  uint16_t GetDestinationPort (void) const;
+};
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
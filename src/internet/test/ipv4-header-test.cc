@@ -38,6 +38,8 @@
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
 
 #include <string>
 #include <sstream>
@@ -255,12 +257,60 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+class Ipv4HeaderViewTest : public TestCase
+{
+public:
+  Ipv4HeaderViewTest ();
+  virtual void DoRun (void);
+};
+
+Ipv4HeaderViewTest::Ipv4HeaderViewTest ()
+  : TestCase ("IPv4 Header View Test")
+{
+}
+
+void
+Ipv4HeaderViewTest::DoRun (void)
+{
+  // the UDP ports are followed by zero bytes which the packet does not store
+  uint8_t ports[4] = { 0x12, 0x34, 0x00, 0x35 };
+  Ptr<Packet> p = Create<Packet> (ports, 4);
+  p->AddAtEnd (Create<Packet> (4));
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetProtocol (17);
+  ipHeader.SetTtl (7);
+  ipHeader.SetIdentification (1234);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ipHeader);
+
+  Ipv4HeaderView ipView (*p);
+  NS_TEST_ASSERT_MSG_EQ (ipView.IsValid (), true, "The packet holds an IPv4 header");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetSource (), Ipv4Address ("10.0.0.2"), "Wrong source");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetDestination (), Ipv4Address ("10.0.0.1"), "Wrong destination");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)ipView.GetProtocol (), 17, "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)ipView.GetTtl (), 7, "Wrong TTL");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetIdentification (), 1234, "Wrong identification");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetPayloadSize (), 8, "Wrong payload size");
+  NS_TEST_EXPECT_MSG_EQ (ipView.GetSerializedSize (), 20, "Wrong header size");
+
+  UdpHeaderView udpView (*p, ipView.GetSerializedSize ());
+  NS_TEST_ASSERT_MSG_EQ (udpView.IsValid (), true, "The packet holds a UDP header");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetSourcePort (), 0x1234, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (udpView.GetDestinationPort (), 53, "Wrong destination port");
+
+  UdpHeaderView tooShort (*p, 24);
+  NS_TEST_EXPECT_MSG_EQ (tooShort.IsValid (), false, "The packet is too short for this header");
+}
+//-----------------------------------------------------------------------------
 class Ipv4HeaderTestSuite : public TestSuite
 {
 public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest);
+    AddTestCase (new Ipv4HeaderViewTest);
   }
 } g_ipv4HeaderTestSuite;
 
@@ -89,12 +89,20 @@ main (int argc, char *argv[])
   Config::SetDefault ("ns3::OnOffApplication::DataRate", StringValue ("1Mbps"));
   Config::SetDefault ("ns3::OnOffApplication::MaxBytes", UintegerValue (512));
   bool nix = true;
+  bool nullmsg = false;
 
   // Parse command line
   CommandLine cmd;
   cmd.AddValue ("nix", "Enable the use of nix-vector or global routing", nix);
+  cmd.AddValue ("nullmsg", "Enable the use of null message synchronization", nullmsg);
   cmd.Parse (argc, argv);
 
+  if (nullmsg)
+    {
+      Config::SetDefault ("ns3::DistributedSimulatorImpl::SynchronizationMode",
+                          StringValue ("NullMessage"));
+    }
+
   // Create leaf nodes on left with system id 0
   NodeContainer leftLeafNodes;
   leftLeafNodes.Create (4, 0);
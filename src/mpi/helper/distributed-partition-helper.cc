@@ -0,0 +1,412 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "distributed-partition-helper.h"
+
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <set>
+#include <queue>
+
+NS_LOG_COMPONENT_DEFINE ("DistributedPartitionHelper");
+
+namespace ns3 {
+
+DistributedPartitionHelper::DistributedPartitionHelper ()
+  : m_imbalance (0.05),
+    m_lookAhead (Seconds (0)),
+    m_cutCost (0)
+{
+}
+
+uint32_t
+DistributedPartitionHelper::AddNode (double weight)
+{
+  m_nodeWeights.push_back (weight);
+  return m_nodeWeights.size () - 1;
+}
+
+void
+DistributedPartitionHelper::EnsureNode (uint32_t node)
+{
+  while (m_nodeWeights.size () <= node)
+    {
+      m_nodeWeights.push_back (1.0);
+    }
+}
+
+void
+DistributedPartitionHelper::AddLink (uint32_t a, uint32_t b, Time delay, double traffic)
+{
+  NS_LOG_FUNCTION (this << a << b << delay << traffic);
+  EnsureNode (a);
+  EnsureNode (b);
+  Link link;
+  link.a = a;
+  link.b = b;
+  link.delay = delay;
+  link.traffic = traffic;
+  m_links.push_back (link);
+}
+
+void
+DistributedPartitionHelper::AddTopology (NodeContainer c)
+{
+  std::set<uint32_t> channels;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      EnsureNode (node->GetId ());
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0 || channel->GetNDevices () < 2)
+            {
+              continue;
+            }
+          if (!channels.insert (channel->GetId ()).second)
+            {
+              continue;
+            }
+
+          uint32_t first = channel->GetDevice (0)->GetNode ()->GetId ();
+          if (device->IsPointToPoint () && channel->GetNDevices () == 2)
+            {
+              TimeValue delay (Seconds (0));
+              channel->GetAttributeFailSafe ("Delay", delay);
+              double traffic = 1.0;
+              DataRateValue rate;
+              if (device->GetAttributeFailSafe ("DataRate", rate))
+                {
+                  traffic = rate.Get ().GetBitRate ();
+                }
+              AddLink (first, channel->GetDevice (1)->GetNode ()->GetId (), delay.Get (), traffic);
+            }
+          else
+            {
+              // Only point-to-point links can cross ranks; keep all the
+              // nodes of any other channel together.
+              for (uint32_t k = 1; k < channel->GetNDevices (); ++k)
+                {
+                  AddLink (first, channel->GetDevice (k)->GetNode ()->GetId (), Seconds (0), 0);
+                }
+            }
+        }
+    }
+}
+
+void
+DistributedPartitionHelper::SetNodeWeight (uint32_t node, double weight)
+{
+  EnsureNode (node);
+  m_nodeWeights[node] = weight;
+}
+
+void
+DistributedPartitionHelper::SetImbalance (double tolerance)
+{
+  m_imbalance = tolerance;
+}
+
+double
+DistributedPartitionHelper::GetCost (const Link &link) const
+{
+  return link.traffic / link.delay.GetSeconds ();
+}
+
+uint32_t
+DistributedPartitionHelper::FindGroup (uint32_t node)
+{
+  while (m_group[node] != node)
+    {
+      m_group[node] = m_group[m_group[node]];
+      node = m_group[node];
+    }
+  return node;
+}
+
+uint32_t
+DistributedPartitionHelper::FindPeripheral (uint32_t start, uint32_t nRanks,
+                                            const std::vector<uint32_t> &part) const
+{
+  // The last unassigned group reached by a breadth-first walk is far from start
+  std::vector<bool> visited (m_groupWeights.size (), false);
+  std::queue<uint32_t> pending;
+  pending.push (start);
+  visited[start] = true;
+  uint32_t last = start;
+  while (!pending.empty ())
+    {
+      last = pending.front ();
+      pending.pop ();
+      for (std::map<uint32_t, double>::const_iterator i = m_adjacency[last].begin ();
+           i != m_adjacency[last].end (); ++i)
+        {
+          if (!visited[i->first] && part[i->first] >= nRanks)
+            {
+              visited[i->first] = true;
+              pending.push (i->first);
+            }
+        }
+    }
+  return last;
+}
+
+void
+DistributedPartitionHelper::Grow (uint32_t nRanks, std::vector<uint32_t> &part) const
+{
+  uint32_t nGroups = m_groupWeights.size ();
+  double total = 0;
+  for (uint32_t g = 0; g < nGroups; ++g)
+    {
+      total += m_groupWeights[g];
+    }
+  uint32_t nextSeed = 0;
+
+  for (uint32_t r = 0; r < nRanks; ++r)
+    {
+      // share what is left evenly among the remaining ranks
+      double target = total / (nRanks - r);
+      double weight = 0;
+      // unassigned groups adjacent to rank r, with their connection cost
+      std::map<uint32_t, double> frontier;
+      double maxWeight = target * (1 + m_imbalance);
+      while (r == nRanks - 1 || weight < target)
+        {
+          // pick the most connected neighbor group which still fits
+          uint32_t u = nGroups;
+          double best = -1;
+          for (std::map<uint32_t, double>::const_iterator i = frontier.begin ();
+               i != frontier.end (); ++i)
+            {
+              bool fits = r == nRanks - 1 || weight + m_groupWeights[i->first] <= maxWeight;
+              if (fits && i->second > best)
+                {
+                  best = i->second;
+                  u = i->first;
+                }
+            }
+          if (u == nGroups && !frontier.empty () && weight > 0)
+            {
+              break;
+            }
+          if (u == nGroups)
+            {
+              // nothing adjacent, start from a new seed
+              while (nextSeed < nGroups && part[nextSeed] < nRanks)
+                {
+                  nextSeed++;
+                }
+              if (nextSeed == nGroups)
+                {
+                  break;
+                }
+              u = FindPeripheral (nextSeed, nRanks, part);
+              if (weight > 0 && r != nRanks - 1
+                  && weight + m_groupWeights[u] > maxWeight)
+                {
+                  break;
+                }
+            }
+          part[u] = r;
+          weight += m_groupWeights[u];
+          total -= m_groupWeights[u];
+          frontier.erase (u);
+          for (std::map<uint32_t, double>::const_iterator i = m_adjacency[u].begin ();
+               i != m_adjacency[u].end (); ++i)
+            {
+              if (part[i->first] >= nRanks)
+                {
+                  frontier[i->first] += i->second;
+                }
+            }
+        }
+    }
+}
+
+void
+DistributedPartitionHelper::Refine (uint32_t nRanks, std::vector<uint32_t> &part) const
+{
+  uint32_t nGroups = m_groupWeights.size ();
+  std::vector<double> rankWeights (nRanks, 0);
+  std::vector<uint32_t> rankSizes (nRanks, 0);
+  double total = 0;
+  for (uint32_t g = 0; g < nGroups; ++g)
+    {
+      rankWeights[part[g]] += m_groupWeights[g];
+      rankSizes[part[g]]++;
+      total += m_groupWeights[g];
+    }
+  double maxWeight = total / nRanks * (1 + m_imbalance);
+
+  for (uint32_t pass = 0; pass < 10; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t u = 0; u < nGroups; ++u)
+        {
+          uint32_t p = part[u];
+          if (rankSizes[p] == 1)
+            {
+              continue;
+            }
+          std::map<uint32_t, double> connection;
+          for (std::map<uint32_t, double>::const_iterator i = m_adjacency[u].begin ();
+               i != m_adjacency[u].end (); ++i)
+            {
+              connection[part[i->first]] += i->second;
+            }
+          double internal = connection[p];
+          uint32_t best = p;
+          double bestGain = 0;
+          for (std::map<uint32_t, double>::const_iterator i = connection.begin ();
+               i != connection.end (); ++i)
+            {
+              uint32_t q = i->first;
+              if (q == p || rankWeights[q] + m_groupWeights[u] > maxWeight)
+                {
+                  continue;
+                }
+              double gain = i->second - internal;
+              bool balances = rankWeights[q] + m_groupWeights[u] < rankWeights[p];
+              if (gain > bestGain || (gain == bestGain && best == p && balances))
+                {
+                  best = q;
+                  bestGain = gain;
+                }
+            }
+          if (best != p)
+            {
+              part[u] = best;
+              rankWeights[p] -= m_groupWeights[u];
+              rankWeights[best] += m_groupWeights[u];
+              rankSizes[p]--;
+              rankSizes[best]++;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+}
+
+std::vector<uint32_t>
+DistributedPartitionHelper::Partition (uint32_t nRanks)
+{
+  NS_LOG_FUNCTION (this << nRanks);
+  NS_ASSERT_MSG (nRanks > 0, "Need at least one rank");
+  uint32_t nNodes = m_nodeWeights.size ();
+
+  // Nodes joined by a zero delay link must stay on the same rank
+  m_group.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_group[i] = i;
+    }
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (!i->delay.IsStrictlyPositive ())
+        {
+          m_group[FindGroup (i->a)] = FindGroup (i->b);
+        }
+    }
+  std::vector<uint32_t> groupOf (nNodes);
+  std::map<uint32_t, uint32_t> roots;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      uint32_t root = FindGroup (i);
+      std::map<uint32_t, uint32_t>::iterator found = roots.find (root);
+      if (found == roots.end ())
+        {
+          found = roots.insert (std::make_pair (root, roots.size ())).first;
+        }
+      groupOf[i] = found->second;
+    }
+
+  m_groupWeights.assign (roots.size (), 0);
+  m_adjacency.assign (roots.size (), std::map<uint32_t, double> ());
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_groupWeights[groupOf[i]] += m_nodeWeights[i];
+    }
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      uint32_t a = groupOf[i->a];
+      uint32_t b = groupOf[i->b];
+      if (a != b)
+        {
+          double cost = GetCost (*i);
+          m_adjacency[a][b] += cost;
+          m_adjacency[b][a] += cost;
+        }
+    }
+
+  std::vector<uint32_t> part (roots.size (), nRanks);
+  Grow (nRanks, part);
+  Refine (nRanks, part);
+
+  m_systemIds.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_systemIds[i] = part[groupOf[i]];
+    }
+
+  m_lookAhead = Seconds (0);
+  m_cutCost = 0;
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (m_systemIds[i->a] == m_systemIds[i->b])
+        {
+          continue;
+        }
+      if (m_lookAhead.IsZero () || i->delay < m_lookAhead)
+        {
+          m_lookAhead = i->delay;
+        }
+      m_cutCost += GetCost (*i);
+    }
+  NS_LOG_INFO ("Partitioned " << nNodes << " nodes on " << nRanks << " ranks, lookahead "
+                              << m_lookAhead << ", cut cost " << m_cutCost);
+  return m_systemIds;
+}
+
+uint32_t
+DistributedPartitionHelper::GetSystemId (uint32_t node) const
+{
+  NS_ASSERT_MSG (node < m_systemIds.size (), "Node " << node << " was not partitioned");
+  return m_systemIds[node];
+}
+
+Time
+DistributedPartitionHelper::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+double
+DistributedPartitionHelper::GetCutCost (void) const
+{
+  return m_cutCost;
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DISTRIBUTED_PARTITION_HELPER_H
+#define DISTRIBUTED_PARTITION_HELPER_H
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Compute a node to rank (system id) assignment for distributed runs
+ *
+ * The helper works on an abstract graph of nodes and links.  The graph can
+ * be described before any node is created, with AddNode and AddLink, and
+ * the result used as the system id of each node passed to
+ * CreateObject<Node>.  It can also be read from an already built topology
+ * with AddTopology; the assignment is then a remapping to use the next time
+ * the same topology is built.
+ *
+ * The assignment balances the node weights among the ranks while keeping
+ * the cost of the links cut between ranks small.  The cost of cutting a
+ * link is its expected traffic divided by its delay: links carrying a lot
+ * of traffic make every packet go through MpiInterface::SendPacket, and
+ * short links reduce the lookahead of the distributed simulator.  Links with
+ * a zero delay, and channels which are not point-to-point, are never cut.
+ *
+ * The partition is grown greedily from a peripheral node of the graph and
+ * then refined by moving boundary nodes to the rank they are most connected
+ * to, as long as the balance tolerance allows it.
+ */
+class DistributedPartitionHelper
+{
+public:
+  DistributedPartitionHelper ();
+
+  /**
+   * \param weight relative cost of simulating the node, for example its
+   *        expected number of events
+   * \return the index of the new node
+   */
+  uint32_t AddNode (double weight = 1.0);
+  /**
+   * \param a index of the first node
+   * \param b index of the second node
+   * \param delay propagation delay of the link, that is its lookahead
+   * \param traffic expected traffic on the link, in any unit consistent
+   *        with the other links
+   *
+   * Nodes which were not added yet are added with a weight of one.
+   */
+  void AddLink (uint32_t a, uint32_t b, Time delay, double traffic = 1.0);
+  /**
+   * \param c nodes of an existing topology
+   *
+   * Add the nodes of c, indexed by their node id, and the channels attached
+   * to their devices.  The delay of a point-to-point link is read from the
+   * Delay attribute of its channel and its traffic from the DataRate
+   * attribute of its devices, if present.
+   */
+  void AddTopology (NodeContainer c);
+  /**
+   * \param node index of the node
+   * \param weight relative cost of simulating the node
+   */
+  void SetNodeWeight (uint32_t node, double weight);
+  /**
+   * \param tolerance maximum relative weight excess of a rank over the
+   *        average, 0.05 by default
+   */
+  void SetImbalance (double tolerance);
+
+  /**
+   * \param nRanks number of ranks (MPI size) to partition into
+   * \return the rank of each node, indexed by node
+   */
+  std::vector<uint32_t> Partition (uint32_t nRanks);
+
+  /**
+   * \param node index of the node
+   * \return the rank assigned to the node by the last Partition call
+   */
+  uint32_t GetSystemId (uint32_t node) const;
+  /**
+   * \return the smallest delay of the links cut by the last Partition call,
+   *         zero if no link was cut
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \return the total cost of the links cut by the last Partition call
+   */
+  double GetCutCost (void) const;
+
+private:
+  struct Link
+  {
+    uint32_t a;
+    uint32_t b;
+    Time delay;
+    double traffic;
+  };
+
+  void EnsureNode (uint32_t node);
+  double GetCost (const Link &link) const;
+  uint32_t FindGroup (uint32_t node);
+  uint32_t FindPeripheral (uint32_t start, uint32_t nRanks, const std::vector<uint32_t> &part) const;
+  void Grow (uint32_t nRanks, std::vector<uint32_t> &part) const;
+  void Refine (uint32_t nRanks, std::vector<uint32_t> &part) const;
+
+  std::vector<double> m_nodeWeights;
+  std::vector<Link> m_links;
+  double m_imbalance;
+
+  // Groups of nodes which must stay on the same rank
+  std::vector<uint32_t> m_group;
+  // Weight and adjacency (neighbor group to cost) of each group
+  std::vector<double> m_groupWeights;
+  std::vector<std::map<uint32_t, double> > m_adjacency;
+
+  std::vector<uint32_t> m_systemIds;
+  Time m_lookAhead;
+  double m_cutCost;
+};
+
+} // namespace ns3
+
+#endif /* DISTRIBUTED_PARTITION_HELPER_H */
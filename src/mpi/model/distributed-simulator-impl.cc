@@ -26,6 +26,7 @@
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
 #include "ns3/pointer.h"
+#include "ns3/enum.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -76,6 +77,12 @@ DistributedSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DistributedSimulatorImpl")
     .SetParent<Object> ()
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("SynchronizationMode",
+                   "The conservative synchronization algorithm used between ranks.",
+                   EnumValue (SYNC_LBTS),
+                   MakeEnumAccessor (&DistributedSimulatorImpl::SetSynchronizationMode),
+                   MakeEnumChecker (SYNC_LBTS, "Lbts",
+                                    SYNC_NULL_MESSAGE, "NullMessage"))
   ;
   return tid;
 }
@@ -105,6 +112,7 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
   m_events = 0;
+  m_synchronizationMode = SYNC_LBTS;
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
@@ -120,6 +128,8 @@ DistributedSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  m_linkLookAhead.clear ();
+  m_nullMessageSent.clear ();
   delete [] m_pLBTS;
   SimulatorImpl::DoDispose ();
 }
@@ -197,6 +207,16 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
               // it the new lookAhead.
               TimeValue delay;
               channel->GetAttribute ("Delay", delay);
+
+              // remember the smallest delay towards each neighbor rank;
+              // this is the per-link lookahead of the null message mode
+              uint32_t remoteId = remoteNode->GetSystemId ();
+              std::map<uint32_t, Time>::iterator la = m_linkLookAhead.find (remoteId);
+              if (la == m_linkLookAhead.end () || delay.Get () < la->second)
+                {
+                  m_linkLookAhead[remoteId] = delay.Get ();
+                }
+
               if (DistributedSimulatorImpl::m_lookAhead.IsZero ())
                 {
                   DistributedSimulatorImpl::m_lookAhead = delay.Get ();
@@ -267,12 +287,45 @@ DistributedSimulatorImpl::Next (void) const
   return TimeStep (NextTs ());
 }
 
+void
+DistributedSimulatorImpl::SetSynchronizationMode (DistributedSimulatorImpl::SynchronizationMode mode)
+{
+  m_synchronizationMode = mode;
+}
+
+DistributedSimulatorImpl::SynchronizationMode
+DistributedSimulatorImpl::GetSynchronizationMode (void) const
+{
+  return m_synchronizationMode;
+}
+
 void
 DistributedSimulatorImpl::Run (void)
 {
 #ifdef NS3_MPI
   CalculateLookAhead ();
   m_stop = false;
+  if (m_synchronizationMode == SYNC_NULL_MESSAGE)
+    {
+      RunNullMessage ();
+    }
+  else
+    {
+      RunLbts ();
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+void
+DistributedSimulatorImpl::RunLbts (void)
+{
+#ifdef NS3_MPI
   while (!m_events->IsEmpty () && !m_stop)
     {
       Time nextTime = Next ();
@@ -316,15 +369,98 @@ DistributedSimulatorImpl::Run (void)
           ProcessOneEvent ();
         }
     }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
 
-  // If the simulator stopped naturally by lack of events, make a
-  // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+void
+DistributedSimulatorImpl::RunNullMessage (void)
+{
+#ifdef NS3_MPI
+  CheckLinkLookAhead ();
+
+  while (!m_events->IsEmpty () && !m_stop)
+    {
+      // Collect packets and null messages from the neighbor ranks
+      MpiInterface::ReceiveMessages ();
+      MpiInterface::TestSendComplete ();
+
+      // Nothing we process from now on can be earlier than our next
+      // event or than the earliest time a neighbor may still send us.
+      Time nextTime = Next ();
+      Time safeTime = GetSafeTime ();
+      SendNullMessages (nextTime < safeTime ? nextTime : safeTime);
+
+      if (nextTime <= safeTime)
+        { // Safe to process
+          ProcessOneEvent ();
+        }
+    }
+
+  // Release the neighbors; we will not send anything anymore.
+  SendNullMessages (GetMaximumSimulationTime ());
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
 }
 
+void
+DistributedSimulatorImpl::CheckLinkLookAhead (void) const
+{
+  for (std::map<uint32_t, Time>::const_iterator i = m_linkLookAhead.begin ();
+       i != m_linkLookAhead.end (); ++i)
+    {
+      if (!i->second.IsStrictlyPositive ())
+        {
+          NS_FATAL_ERROR ("Null message synchronization needs a non-zero delay on every remote link");
+        }
+    }
+}
+
+void
+DistributedSimulatorImpl::SendNullMessages (Time lbts)
+{
+#ifdef NS3_MPI
+  Time infinity = GetMaximumSimulationTime ();
+  for (std::map<uint32_t, Time>::const_iterator i = m_linkLookAhead.begin ();
+       i != m_linkLookAhead.end (); ++i)
+    {
+      Time guarantee = infinity;
+      if (lbts < infinity - i->second)
+        {
+          guarantee = lbts + i->second;
+        }
+      std::map<uint32_t, Time>::iterator sent = m_nullMessageSent.find (i->first);
+      if (sent != m_nullMessageSent.end () && guarantee <= sent->second)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("null message to " << i->first << " guarantee " << guarantee);
+      MpiInterface::SendNullMessage (guarantee, i->first);
+      m_nullMessageSent[i->first] = guarantee;
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+Time
+DistributedSimulatorImpl::GetSafeTime (void) const
+{
+  Time safeTime = GetMaximumSimulationTime ();
+  for (std::map<uint32_t, Time>::const_iterator i = m_linkLookAhead.begin ();
+       i != m_linkLookAhead.end (); ++i)
+    {
+      Time guarantee = MpiInterface::GetNullMessageTime (i->first);
+      if (guarantee < safeTime)
+        {
+          safeTime = guarantee;
+        }
+    }
+  return safeTime;
+}
+
 uint32_t DistributedSimulatorImpl::GetSystemId () const
 {
   return m_myId;
@@ -25,6 +25,7 @@
 #include "ns3/ptr.h"
 
 #include <list>
+#include <map>
 
 namespace ns3 {
 
@@ -87,12 +88,30 @@ private:
  * \ingroup mpi
  *
  * \brief distributed simulator implementation using lookahead
+ *
+ * Two conservative synchronization algorithms are available and selected
+ * with the SynchronizationMode attribute.  The default (SYNC_LBTS) computes a
+ * global lower bound on time stamp with MPI_Allgather each time a rank runs
+ * out of safe events, so all ranks advance in lock step.  SYNC_NULL_MESSAGE
+ * uses the Chandy-Misra-Bryant null message algorithm instead: each rank only
+ * exchanges time guarantees with the ranks it shares a remote point-to-point
+ * link with, using the delay of those links as a per-link lookahead.  Ranks
+ * with sparse cross-partition traffic can then run ahead of each other.
+ *
+ * In SYNC_NULL_MESSAGE mode every link crossing a rank boundary must have a
+ * non-zero delay, and the simulation should be ended with Simulator::Stop
+ * on all ranks.
  */
 class DistributedSimulatorImpl : public SimulatorImpl
 {
 public:
   static TypeId GetTypeId (void);
 
+  enum SynchronizationMode {
+    SYNC_LBTS, /** Global LBTS computed by all-gather among all ranks */
+    SYNC_NULL_MESSAGE /** Chandy-Misra-Bryant null messages between neighbor ranks */
+  };
+
   DistributedSimulatorImpl ();
   ~DistributedSimulatorImpl ();
 
@@ -116,9 +135,41 @@ public:
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \param mode the synchronization algorithm used by Run
+   */
+  void SetSynchronizationMode (DistributedSimulatorImpl::SynchronizationMode mode);
+  /**
+   * \return the synchronization algorithm used by Run
+   */
+  DistributedSimulatorImpl::SynchronizationMode GetSynchronizationMode (void) const;
+
 private:
+  friend class DistributedLookAheadTestCase;
+  friend class DistributedNullMessageTestCase;
+
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
+  void RunLbts (void);
+  void RunNullMessage (void);
+  /**
+   * Abort the simulation if a remote link has no lookahead, since the
+   * null messages could then never let any rank advance.
+   */
+  void CheckLinkLookAhead (void) const;
+  /**
+   * \param lbts lower bound on the time stamp of any event this rank
+   *        may still process
+   *
+   * Send a null message to every neighbor rank whose guarantee
+   * (lbts plus the lookahead of the link to that rank) has grown
+   * since the last null message sent to it.
+   */
+  void SendNullMessages (Time lbts);
+  /**
+   * \return the smallest time guarantee received from the neighbor ranks
+   */
+  Time GetSafeTime (void) const;
 
   void ProcessOneEvent (void);
   uint64_t NextTs (void) const;
@@ -142,6 +193,12 @@ private:
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
 
+  SynchronizationMode m_synchronizationMode;
+  // Smallest delay of the remote links to each neighbor rank
+  std::map<uint32_t, Time> m_linkLookAhead;
+  // Last guarantee sent in a null message to each neighbor rank
+  std::map<uint32_t, Time> m_nullMessageSent;
+
 };
 
 } // namespace ns3
@@ -77,6 +77,7 @@ bool                  MpiInterface::m_enabled = false;
 uint32_t              MpiInterface::m_rxCount = 0;
 uint32_t              MpiInterface::m_txCount = 0;
 std::list<SentBuffer> MpiInterface::m_pendingTx;
+std::vector<Time>     MpiInterface::m_nullMessageTimes;
 
 #ifdef NS3_MPI
 MPI_Request* MpiInterface::m_requests;
@@ -95,6 +96,7 @@ MpiInterface::Destroy ()
   delete [] m_requests;
 
   m_pendingTx.clear ();
+  m_nullMessageTimes.clear ();
 #endif
 }
 
@@ -157,6 +159,7 @@ MpiInterface::Enable (int* pargc, char*** pargv)
   // Post a non-blocking receive for all peers
   m_pRxBuffers = new char*[m_size];
   m_requests = new MPI_Request[m_size];
+  m_nullMessageTimes.assign (m_size, Seconds (0));
   for (uint32_t i = 0; i < GetSize (); ++i)
     {
       m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
@@ -201,6 +204,43 @@ MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint
 #endif
 }
 
+void
+MpiInterface::SendNullMessage (const Time& guarantee, uint32_t sid)
+{
+#ifdef NS3_MPI
+  SentBuffer sendBuf;
+  m_pendingTx.push_back (sendBuf);
+  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
+
+  uint8_t* buffer =  new uint8_t[16];
+  i->SetBuffer (buffer);
+  // Same layout as a packet header, without the packet; the time is
+  // sent in time steps so that the guarantee is exact
+  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
+  *pTime++ = guarantee.GetTimeStep ();
+  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
+  *pData++ = NULL_MESSAGE_NODE;
+  *pData++ = 0;
+
+  // Null messages are not counted in m_txCount; they never carry
+  // events, so they are not transients for the LBTS computation
+  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), 16, MPI_CHAR, sid,
+             0, MPI_COMM_WORLD, (i->GetRequest ()));
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+Time
+MpiInterface::GetNullMessageTime (uint32_t sid)
+{
+  if (sid >= m_nullMessageTimes.size ())
+    {
+      return Seconds (0);
+    }
+  return m_nullMessageTimes[sid];
+}
+
 void
 MpiInterface::ReceiveMessages ()
 { // Poll the non-block reads to see if data arrived
@@ -218,7 +258,6 @@ MpiInterface::ReceiveMessages ()
         }
       int count;
       MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
 
       // Get the meta data first
       uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
@@ -227,6 +266,20 @@ MpiInterface::ReceiveMessages ()
       uint32_t node = *pData++;
       uint32_t dev  = *pData++;
 
+      if (node == NULL_MESSAGE_NODE)
+        { // A null message; just record the sender's guarantee
+          Time guarantee = TimeStep (nanoSeconds);
+          if (guarantee > m_nullMessageTimes[status.MPI_SOURCE])
+            {
+              m_nullMessageTimes[status.MPI_SOURCE] = guarantee;
+            }
+          MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+                     MPI_COMM_WORLD, &m_requests[index]);
+          continue;
+        }
+
+      m_rxCount++; // Count this receive
+
       Time rxTime = NanoSeconds (nanoSeconds);
 
       count -= sizeof (nanoSeconds) + sizeof (node) + sizeof (dev);
@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -50,6 +51,12 @@ namespace ns3 {
  */
 const uint32_t MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * destination node id marking a null message
+ * rather than a serialized packet
+ */
+const uint32_t NULL_MESSAGE_NODE = 0xffffffff;
+
 /**
  * \ingroup mpi
  *
@@ -127,6 +134,21 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   static void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * \param guarantee no packet sent from now on to the destination
+   *        rank will be received earlier than this time
+   * \param sid destination rank
+   *
+   * Send a null message (time guarantee without a packet) used by the
+   * null message synchronization of DistributedSimulatorImpl
+   */
+  static void SendNullMessage (const Time &guarantee, uint32_t sid);
+  /**
+   * \param sid source rank
+   * \return the latest time guarantee received in a null message from
+   *         that rank, zero if none was received yet
+   */
+  static Time GetNullMessageTime (uint32_t sid);
   /**
    * Check for received messages complete
    */
@@ -145,6 +167,8 @@ public:
   static uint32_t GetTxCount ();
 
 private:
+  friend class DistributedNullMessageTestCase;
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -164,6 +188,9 @@ private:
 
   // List of pending non-blocking sends
   static std::list<SentBuffer> m_pendingTx;
+
+  // Latest null message guarantee received from each rank
+  static std::vector<Time> m_nullMessageTimes;
 };
 
 } // namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/distributed-simulator-impl.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/object-factory.h"
+#include "ns3/nstime.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+static Ptr<DistributedSimulatorImpl>
+CreateDistributedSimulator (void)
+{
+  Ptr<DistributedSimulatorImpl> sim = CreateObject<DistributedSimulatorImpl> ();
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MapScheduler");
+  sim->SetScheduler (factory);
+  return sim;
+}
+
+/**
+ * A remote link without delay must abort the null message mode.  The
+ * check runs in a child process since NS_FATAL_ERROR terminates it.
+ */
+class DistributedLookAheadTestCase : public TestCase
+{
+public:
+  DistributedLookAheadTestCase ();
+  virtual void DoRun (void);
+private:
+  bool CheckAborts (Time delay);
+};
+
+DistributedLookAheadTestCase::DistributedLookAheadTestCase ()
+  : TestCase ("Check that a zero lookahead is a fatal error")
+{
+}
+
+bool
+DistributedLookAheadTestCase::CheckAborts (Time delay)
+{
+  Ptr<DistributedSimulatorImpl> sim = CreateDistributedSimulator ();
+  sim->m_linkLookAhead[1] = MilliSeconds (10);
+  sim->m_linkLookAhead[2] = delay;
+
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      // keep the fatal error message out of the test output
+      int null = open ("/dev/null", O_WRONLY);
+      dup2 (null, 2);
+      sim->CheckLinkLookAhead ();
+      _exit (0);
+    }
+  int status = 0;
+  waitpid (pid, &status, 0);
+  sim->Dispose ();
+  return !WIFEXITED (status) || WEXITSTATUS (status) != 0;
+}
+
+void
+DistributedLookAheadTestCase::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (CheckAborts (Seconds (0)), true, "A zero delay remote link should be fatal");
+  NS_TEST_EXPECT_MSG_EQ (CheckAborts (MilliSeconds (1)), false, "Non-zero delays should be accepted");
+}
+
+/**
+ * Run a single rank that is its own neighbor: the null messages it
+ * sends come back to it, so the guarantees can be checked on both ends.
+ */
+class DistributedNullMessageTestCase : public TestCase
+{
+public:
+  DistributedNullMessageTestCase ();
+  virtual void DoRun (void);
+private:
+  void Receive (Time expected);
+};
+
+DistributedNullMessageTestCase::DistributedNullMessageTestCase ()
+  : TestCase ("Check the guarantees sent and received in null messages")
+{
+}
+
+void
+DistributedNullMessageTestCase::Receive (Time expected)
+{
+  for (uint32_t i = 0; i < 1000000 && MpiInterface::GetNullMessageTime (0) != expected; ++i)
+    {
+      MpiInterface::ReceiveMessages ();
+    }
+}
+
+void
+DistributedNullMessageTestCase::DoRun (void)
+{
+  MpiInterface::Enable (0, 0);
+  Ptr<DistributedSimulatorImpl> sim = CreateDistributedSimulator ();
+  Time infinity = sim->GetMaximumSimulationTime ();
+  sim->m_linkLookAhead[0] = MilliSeconds (10);
+
+  NS_TEST_EXPECT_MSG_EQ (sim->GetSafeTime (), Seconds (0), "A silent neighbor should block at time zero");
+
+  sim->SendNullMessages (Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (MpiInterface::m_pendingTx.size (), 1, "One null message per neighbor");
+  Receive (MilliSeconds (1010));
+  NS_TEST_EXPECT_MSG_EQ (sim->GetSafeTime (), MilliSeconds (1010), "The guarantee is lbts plus the link lookahead");
+
+  sim->SendNullMessages (Seconds (1));
+  sim->SendNullMessages (MilliSeconds (500));
+  NS_TEST_EXPECT_MSG_EQ (MpiInterface::m_pendingTx.size (), 1, "A guarantee that did not grow should not be sent again");
+
+  sim->SendNullMessages (Seconds (2));
+  NS_TEST_EXPECT_MSG_EQ (MpiInterface::m_pendingTx.size (), 2, "A larger guarantee should be sent");
+  Receive (MilliSeconds (2010));
+  NS_TEST_EXPECT_MSG_EQ (sim->GetSafeTime (), MilliSeconds (2010), "The safe time should follow the new guarantee");
+
+  sim->SendNullMessages (infinity - MilliSeconds (5));
+  Receive (infinity);
+  NS_TEST_EXPECT_MSG_EQ (sim->GetSafeTime (), infinity, "The guarantee should saturate instead of overflowing");
+  sim->SendNullMessages (infinity);
+  NS_TEST_EXPECT_MSG_EQ (MpiInterface::m_pendingTx.size (), 3, "Nothing is larger than the maximum time");
+
+  sim->m_linkLookAhead[1] = MilliSeconds (10);
+  NS_TEST_EXPECT_MSG_EQ (sim->GetSafeTime (), Seconds (0), "The safe time is the smallest guarantee");
+
+  for (uint32_t i = 0; i < 1000000 && !MpiInterface::m_pendingTx.empty (); ++i)
+    {
+      MpiInterface::TestSendComplete ();
+    }
+  sim->Dispose ();
+  MpiInterface::Destroy ();
+  MpiInterface::Disable ();
+}
+
+static class DistributedNullMessageTestSuite : public TestSuite
+{
+public:
+  DistributedNullMessageTestSuite ()
+    : TestSuite ("distributed-null-message", UNIT)
+  {
+    // before MPI is initialized, since it forks
+    AddTestCase (new DistributedLookAheadTestCase ());
+    AddTestCase (new DistributedNullMessageTestCase ());
+  }
+} g_distributedNullMessageTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/distributed-partition-helper.h"
+
+namespace ns3 {
+
+/**
+ * Two stars of four leaves joined by a long link between their hubs
+ * must be split on that link.
+ */
+class DumbbellPartitionTestCase : public TestCase
+{
+public:
+  DumbbellPartitionTestCase ();
+  virtual void DoRun (void);
+};
+
+DumbbellPartitionTestCase::DumbbellPartitionTestCase ()
+  : TestCase ("Check that a dumbbell is cut on its bottleneck")
+{
+}
+
+void
+DumbbellPartitionTestCase::DoRun (void)
+{
+  DistributedPartitionHelper helper;
+  // hubs are 0 and 5, leaves 1-4 and 6-9
+  for (uint32_t i = 1; i < 5; ++i)
+    {
+      helper.AddLink (i, 0, MilliSeconds (2), 1e6);
+      helper.AddLink (i + 5, 5, MilliSeconds (2), 1e6);
+    }
+  helper.AddLink (0, 5, MilliSeconds (10), 1e6);
+
+  std::vector<uint32_t> ids = helper.Partition (2);
+  NS_TEST_ASSERT_MSG_EQ (ids.size (), 10, "Every node should have a system id");
+  for (uint32_t i = 1; i < 5; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ids[i], ids[0], "Left leaves should stay with the left hub");
+      NS_TEST_EXPECT_MSG_EQ (ids[i + 5], ids[5], "Right leaves should stay with the right hub");
+    }
+  NS_TEST_EXPECT_MSG_NE (ids[0], ids[5], "The hubs should be on different ranks");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetLookAhead (), MilliSeconds (10), "Only the bottleneck should be cut");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetSystemId (7), ids[7], "GetSystemId should match Partition");
+}
+
+/**
+ * A ring with one zero delay link: the two nodes of that link must never
+ * be split and every rank should get the same number of nodes.
+ */
+class RingPartitionTestCase : public TestCase
+{
+public:
+  RingPartitionTestCase ();
+  virtual void DoRun (void);
+};
+
+RingPartitionTestCase::RingPartitionTestCase ()
+  : TestCase ("Check balance and zero delay links on a ring")
+{
+}
+
+void
+RingPartitionTestCase::DoRun (void)
+{
+  DistributedPartitionHelper helper;
+  uint32_t n = 12;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      helper.AddNode ();
+    }
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Time delay = (i == 3) ? Seconds (0) : MilliSeconds (1);
+      helper.AddLink (i, (i + 1) % n, delay);
+    }
+
+  std::vector<uint32_t> ids = helper.Partition (3);
+  std::vector<uint32_t> sizes (3, 0);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      NS_TEST_ASSERT_MSG_LT (ids[i], 3, "System id out of range");
+      sizes[ids[i]]++;
+    }
+  for (uint32_t r = 0; r < 3; ++r)
+    {
+      NS_TEST_EXPECT_MSG_EQ (sizes[r], 4, "Ranks should be balanced");
+    }
+  NS_TEST_EXPECT_MSG_EQ (ids[3], ids[4], "A zero delay link must not be cut");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetLookAhead (), MilliSeconds (1), "Lookahead is the smallest cut delay");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetCutCost (), 3000, "A ring split in three arcs cuts three links");
+}
+
+static class DistributedPartitionTestSuite : public TestSuite
+{
+public:
+  DistributedPartitionTestSuite ()
+    : TestSuite ("distributed-partition", UNIT)
+  {
+    AddTestCase (new DumbbellPartitionTestCase ());
+    AddTestCase (new RingPartitionTestCase ());
+  }
+} g_distributedPartitionTestSuite;
+
+} // namespace ns3
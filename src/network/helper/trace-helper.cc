@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/binary-trace.h"
 
 #include "trace-helper.h"
 
@@ -201,6 +202,14 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, bool compress)
+{
+  NS_LOG_FUNCTION (filename << compress);
+  // as for the text files, the file is closed with the last reference to the wrapper
+  return Create<OutputStreamWrapper> (new BinaryTraceWriter (filename, compress));
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -288,6 +297,32 @@ AsciiTraceHelper::GetFilenameFromInterfacePair (
   return oss.str ();
 }
 
+bool
+AsciiTraceHelper::WriteBinary (Ptr<OutputStreamWrapper> stream, char type, std::string const &context,
+                               Ptr<const Packet> p)
+{
+  BinaryTraceWriter *writer = stream->GetBinaryWriter ();
+  if (writer == 0)
+    {
+      return false;
+    }
+  writer->Write (type, context, p);
+  return true;
+}
+
+bool
+AsciiTraceHelper::WriteBinary (Ptr<OutputStreamWrapper> stream, char type, std::string const &context,
+                               uint32_t interface, Ptr<const Packet> p, uint32_t size, bool printInterface)
+{
+  BinaryTraceWriter *writer = stream->GetBinaryWriter ();
+  if (writer == 0)
+    {
+      return false;
+    }
+  writer->Write (type, context, interface, p, size, printInterface);
+  return true;
+}
+
 //
 // One of the basic default trace sink sets.  Enqueue:
 //
@@ -303,6 +338,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, '+', "", p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -310,6 +349,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, '+', context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -329,6 +372,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, 'd', "", p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -336,6 +383,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, 'd', context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -356,6 +407,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, '-', "", p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -363,6 +418,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, '-', context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -380,6 +439,10 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, 'r', "", p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -387,6 +450,10 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (WriteBinary (stream, 'r', context, p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
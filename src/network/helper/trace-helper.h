@@ -155,6 +155,18 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create a file for binary traces and a stream wrapper to carry it
+   *
+   * The default trace sinks write a fixed-width binary record for each event
+   * to the file, instead of a line of text.  The file can be read back with
+   * BinaryTraceDecode or the print-binary-trace program.
+   *
+   * @param filename the name of the file to create
+   * @param compress compress the file with zlib, if ns-3 was built with it
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename, bool compress = false);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -215,6 +227,32 @@ public:
   void HookDefaultReceiveSinkWithContext (Ptr<T> object, 
                                           std::string context, std::string traceName, Ptr<OutputStreamWrapper> stream);
 
+  /**
+   * \param stream the stream of the trace
+   * \param type the type of the event, such as '+' or 'r'
+   * \param context the trace context, or an empty string
+   * \param p the packet
+   * \returns true if the stream is binary and the event was written to it,
+   *          false if the trace sink has to print the event as text.
+   */
+  static bool WriteBinary (Ptr<OutputStreamWrapper> stream, char type, std::string const &context,
+                           Ptr<const Packet> p);
+  /**
+   * \param stream the stream of the trace
+   * \param type the type of the event, such as '+' or 'r'
+   * \param context the trace context, or an empty string
+   * \param interface the device, or interface, of the event
+   * \param p the packet
+   * \param size the size to record, see BinaryTraceWriter::Write
+   * \param printInterface whether the ascii traces print the interface
+   *        after the context
+   * \returns true if the stream is binary and the event was written to it,
+   *          false if the trace sink has to print the event as text.
+   */
+  static bool WriteBinary (Ptr<OutputStreamWrapper> stream, char type, std::string const &context,
+                           uint32_t interface, Ptr<const Packet> p, uint32_t size,
+                           bool printInterface = false);
+
   static void DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> file, Ptr<const Packet> p);
   static void DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> file, std::string context, Ptr<const Packet> p);
 
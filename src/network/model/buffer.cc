@@ -20,6 +20,11 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
+
+#ifdef BUFFER_FREE_LIST_KEY
+#include <pthread.h>
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
@@ -71,11 +76,45 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+BUFFER_THREAD_LOCAL uint32_t Buffer::g_maxSize = 0;
+BUFFER_THREAD_LOCAL Buffer::FreeList *Buffer::g_freeList = 0;
+BUFFER_THREAD_LOCAL uint64_t Buffer::g_freeListHits = 0;
+BUFFER_THREAD_LOCAL uint64_t Buffer::g_freeListMisses = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
+#ifdef BUFFER_FREE_LIST_KEY
+namespace {
+/* The free lists of the other threads are destroyed when they exit by
+ * the destructor of this key, which is never called for the main thread.
+ */
+pthread_key_t g_freeListKey;
+pthread_once_t g_freeListKeyOnce = PTHREAD_ONCE_INIT;
+} // anonymous namespace
+
+void
+Buffer::CreateFreeListKey (void)
+{
+  pthread_key_create (&g_freeListKey, &Buffer::DestroyFreeList);
+}
+#endif /* BUFFER_FREE_LIST_KEY */
+
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+{
+  Buffer::DestroyFreeList (0);
+}
+
+void
+Buffer::CreateFreeList (void)
+{
+  g_freeList = new Buffer::FreeList ();
+#ifdef BUFFER_FREE_LIST_KEY
+  pthread_once (&g_freeListKeyOnce, &Buffer::CreateFreeListKey);
+  pthread_setspecific (g_freeListKey, g_freeList);
+#endif
+}
+
+void
+Buffer::DestroyFreeList (void *)
 {
   if (IS_INITIALIZED (g_freeList))
     {
@@ -93,7 +132,11 @@ void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+  /* the buffer may have been created by another thread */
+  if (IS_UNINITIALIZED (g_freeList))
+    {
+      CreateFreeList ();
+    }
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -105,6 +148,13 @@ Buffer::Recycle (struct Buffer::Data *data)
   else
     {
       NS_ASSERT (IS_INITIALIZED (g_freeList));
+      /* a recycled buffer is accounted as freed until it is reused,
+       * possibly in another context
+       */
+      if (MemoryAccounting::IsEnabled ())
+        {
+          MemoryAccounting::Free (data);
+        }
       g_freeList->push_back (data);
     }
 }
@@ -115,7 +165,7 @@ Buffer::Create (uint32_t dataSize)
   /* try to find a buffer correctly sized. */
   if (IS_UNINITIALIZED (g_freeList))
     {
-      g_freeList = new Buffer::FreeList ();
+      CreateFreeList ();
     }
   else if (IS_INITIALIZED (g_freeList))
     {
@@ -126,15 +176,33 @@ Buffer::Create (uint32_t dataSize)
           if (data->m_size >= dataSize) 
             {
               data->m_count = 1;
+              g_freeListHits++;
+              if (MemoryAccounting::IsEnabled ())
+                {
+                  MemoryAccounting::Allocate (data, "ns3::Buffer", GetAllocationSize (data->m_size));
+                }
               return data;
             }
           Buffer::Deallocate (data);
         }
     }
+  g_freeListMisses++;
   struct Buffer::Data *data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
   return data;
 }
+
+uint64_t
+Buffer::GetFreeListHits (void)
+{
+  return g_freeListHits;
+}
+
+uint64_t
+Buffer::GetFreeListMisses (void)
+{
+  return g_freeListMisses;
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -148,8 +216,26 @@ Buffer::Create (uint32_t size)
 {
   return Allocate (size);
 }
+
+uint64_t
+Buffer::GetFreeListHits (void)
+{
+  return 0;
+}
+
+uint64_t
+Buffer::GetFreeListMisses (void)
+{
+  return 0;
+}
 #endif /* BUFFER_FREE_LIST */
 
+uint32_t
+Buffer::GetAllocationSize (uint32_t dataSize)
+{
+  return dataSize - 1 + sizeof (struct Buffer::Data);
+}
+
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
 {
@@ -158,11 +244,15 @@ Buffer::Allocate (uint32_t reqSize)
       reqSize = 1;
     }
   NS_ASSERT (reqSize >= 1);
-  uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
+  uint32_t size = GetAllocationSize (reqSize);
   uint8_t *b = new uint8_t [size];
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (data, "ns3::Buffer", size);
+    }
   return data;
 }
 
@@ -170,6 +260,10 @@ void
 Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_ASSERT (data->m_count == 0);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Free (data);
+    }
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
@@ -398,44 +492,191 @@ Buffer::AddAtEnd (uint32_t end)
   return dirty;
 }
 
+void
+Buffer::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data->m_count == 1)
+    {
+      return;
+    }
+  uint32_t size = GetInternalSize ();
+  struct Buffer::Data *newData = Buffer::Create (size);
+  memcpy (newData->m_data, m_data->m_data + m_start, size);
+  m_data->m_count--;
+  m_data = newData;
+
+  int32_t delta = -m_start;
+  m_zeroAreaStart += delta;
+  m_zeroAreaEnd += delta;
+  m_end += delta;
+  m_start += delta;
+
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
+  NS_ASSERT (CheckInternalState ());
+}
+
+void
+Buffer::AddAtEnd (const Buffer &o, uint32_t start, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &o << start << size);
+  if (size == 0)
+    {
+      return;
+    }
+  // the iterators cannot copy bytes within the same data
+  if (m_data == o.m_data)
+    {
+      Unshare ();
+    }
+  AddAtEnd (size);
+  Buffer::Iterator dst = End ();
+  dst.Prev (size);
+  Buffer::Iterator srcStart = o.Begin ();
+  srcStart.Next (start);
+  Buffer::Iterator srcEnd = srcStart;
+  srcEnd.Next (size);
+  dst.Write (srcStart, srcEnd);
+}
+
 void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
-      o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
-    {
-      /**
-       * This is an optimization which kicks in when
-       * we attempt to aggregate two buffers which contain
-       * adjacent zero areas.
+  // o may be this buffer
+  Buffer src = o;
+  uint32_t srcZeroSize = src.m_zeroAreaEnd - src.m_zeroAreaStart;
+  uint32_t srcHead = src.m_zeroAreaStart - src.m_start;
+  if (srcZeroSize == 0)
+    {
+      AddAtEnd (src, 0, src.GetSize ());
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_zeroAreaEnd != m_zeroAreaStart &&
+      (m_end != m_zeroAreaEnd || srcHead != 0))
+    {
+      /* Real bytes between the two zero areas: a buffer holds a single
+       * zero area so both have to be materialized.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
-      m_end = m_zeroAreaEnd;
-      m_data->m_dirtyEnd = m_zeroAreaEnd;
-      uint32_t endData = o.m_end - o.m_zeroAreaEnd;
-      AddAtEnd (endData);
-      Buffer::Iterator dst = End ();
-      dst.Prev (endData);
-      Buffer::Iterator src = o.End ();
-      src.Prev (endData);
-      dst.Write (src, o.End ());
+      Buffer dst = CreateFullCopy ();
+      Buffer full = src.CreateFullCopy ();
+      dst.AddAtEnd (full.GetSize ());
+      Buffer::Iterator destStart = dst.End ();
+      destStart.Prev (full.GetSize ());
+      destStart.Write (full.Begin (), full.End ());
+      *this = dst;
       NS_ASSERT (CheckInternalState ());
       return;
     }
 
-  Buffer dst = CreateFullCopy ();
-  Buffer src = o.CreateFullCopy ();
+  /* Either we have no zero area, or it is at our end and the zero area
+   * of o is at its start: the two zero areas are merged and stay virtual.
+   * An empty zero area can be moved anywhere, so it is moved after the
+   * real bytes of o which precede its zero area.
+   */
+  AddAtEnd (src, 0, srcHead);
+  if (m_zeroAreaEnd == m_zeroAreaStart)
+    {
+      m_zeroAreaStart = m_end;
+      m_zeroAreaEnd = m_end;
+    }
+  // other users of our data do not expect it to grow past their zero area
+  Unshare ();
+  m_zeroAreaEnd += srcZeroSize;
+  m_end = m_zeroAreaEnd;
+  m_data->m_dirtyEnd = m_end;
+  AddAtEnd (src, srcHead + srcZeroSize, src.m_end - src.m_zeroAreaEnd);
+  m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+  LOG_INTERNAL_STATE ("add buffer=" << &o << ", ");
+  NS_ASSERT (CheckInternalState ());
+}
 
-  dst.AddAtEnd (src.GetSize ());
-  Buffer::Iterator destStart = dst.End ();
-  destStart.Prev (src.GetSize ());
-  destStart.Write (src.Begin (), src.End ());
+void
+Buffer::AddAtEnd (const std::vector<Buffer> &buffers)
+{
+  NS_LOG_FUNCTION (this << buffers.size ());
+  NS_ASSERT (CheckInternalState ());
+  /* Find out whether the zero areas can all be merged, as the zero area
+   * of a single buffer is appended by AddAtEnd, and count the real bytes
+   * which are copied.
+   */
+  bool hasZero = m_zeroAreaEnd != m_zeroAreaStart;
+  bool zeroAtEnd = m_zeroAreaEnd == m_end;
+  bool merge = true;
+  uint32_t realSize = 0;
+  uint32_t size = 0;
+  for (std::vector<Buffer>::const_iterator i = buffers.begin (); i != buffers.end (); ++i)
+    {
+      uint32_t zeroSize = i->m_zeroAreaEnd - i->m_zeroAreaStart;
+      size += i->GetSize ();
+      realSize += i->GetSize () - zeroSize;
+      if (zeroSize == 0)
+        {
+          zeroAtEnd = zeroAtEnd && i->GetSize () == 0;
+        }
+      else if (!hasZero || (zeroAtEnd && i->m_zeroAreaStart == i->m_start))
+        {
+          hasZero = true;
+          zeroAtEnd = i->m_zeroAreaEnd == i->m_end;
+        }
+      else
+        {
+          merge = false;
+        }
+    }
+
+  if (merge)
+    {
+      Reserve (realSize);
+      for (std::vector<Buffer>::const_iterator i = buffers.begin (); i != buffers.end (); ++i)
+        {
+          AddAtEnd (*i);
+        }
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
+  // a buffer holds a single zero area so all of them are materialized
+  Buffer dst = CreateFullCopy ();
+  dst.Reserve (size);
+  for (std::vector<Buffer>::const_iterator i = buffers.begin (); i != buffers.end (); ++i)
+    {
+      if (i->GetSize () == 0)
+        {
+          continue;
+        }
+      dst.AddAtEnd (i->GetSize ());
+      Buffer::Iterator start = dst.End ();
+      start.Prev (i->GetSize ());
+      start.Write (i->Begin (), i->End ());
+    }
   *this = dst;
+  m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+  LOG_INTERNAL_STATE ("add buffers=" << buffers.size () << ", ");
+  NS_ASSERT (CheckInternalState ());
+}
+
+void
+Buffer::Reserve (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  if (m_data->m_count == 1 && GetInternalEnd () + end <= m_data->m_size)
+    {
+      return;
+    }
+  // the room at the start is kept for the headers
+  struct Buffer::Data *newData = Buffer::Create (GetInternalEnd () + end);
+  memcpy (newData->m_data + m_start, m_data->m_data + m_start, GetInternalSize ());
+  m_data->m_count--;
+  if (m_data->m_count == 0)
+    {
+      Buffer::Recycle (m_data);
+    }
+  m_data = newData;
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -721,6 +962,27 @@ Buffer::PeekData (void) const
   return m_data->m_data + m_start;
 }
 
+uint8_t const *
+Buffer::PeekBytes (uint32_t start, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << start << size);
+  uint32_t begin = m_start + start;
+  uint32_t end = begin + size;
+  if (end > m_end)
+    {
+      return 0;
+    }
+  if (end <= m_zeroAreaStart)
+    {
+      return m_data->m_data + begin;
+    }
+  if (begin >= m_zeroAreaEnd)
+    {
+      return m_data->m_data + m_zeroAreaStart + (begin - m_zeroAreaEnd);
+    }
+  return 0;
+}
+
 void
 Buffer::CopyData (std::ostream *os, uint32_t size) const
 {
@@ -846,25 +1108,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the written bytes are all on the same side of our zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
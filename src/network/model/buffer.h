@@ -24,8 +24,25 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/core-config.h"
 
-#define noBUFFER_FREE_LIST 1
+/* Each thread keeps its own free list so that buffers can be recycled
+ * without locking.  Without thread-local storage, buffers are only
+ * recycled if the simulator is single-threaded.
+ */
+#if defined (HAVE_TLS)
+#define BUFFER_FREE_LIST 1
+#define BUFFER_THREAD_LOCAL __thread
+#elif !defined (HAVE_PTHREAD_H)
+#define BUFFER_FREE_LIST 1
+#define BUFFER_THREAD_LOCAL
+#endif
+/* The free lists of the threads other than the main one are released,
+ * when they exit, by the destructor of a pthread key.
+ */
+#if defined (HAVE_TLS) && defined (HAVE_PTHREAD_H)
+#define BUFFER_FREE_LIST_KEY 1
+#endif
 
 namespace ns3 {
 
@@ -411,6 +428,17 @@ private:
    */
   uint8_t const*PeekData (void) const;
 
+  /**
+   * \param start offset of the first byte from the start of the buffer
+   * \param size number of bytes
+   * \returns a pointer to these bytes if they are stored contiguously,
+   *          0 if they overlap the virtual zero area or the end of the buffer.
+   *
+   * Unlike PeekData, this method never copies the buffer. The returned
+   * pointer is invalidated by any change to the buffer.
+   */
+  uint8_t const *PeekBytes (uint32_t start, uint32_t size) const;
+
   /**
    * \param start size to reserve
    * \returns true if the buffer needed resizing, false otherwise.
@@ -442,6 +470,17 @@ private:
    * pointing to this Buffer.
    */
   void AddAtEnd (const Buffer &o);
+  /**
+   * \param buffers the buffers to append, in order, to the end of
+   *        this buffer.
+   *
+   * Unlike successive calls to AddAtEnd, the real bytes of this buffer
+   * are copied at most once, and the virtual zero areas of the buffers
+   * stay virtual if they can be merged into a single one.
+   * Any call to this method invalidates any Iterator
+   * pointing to this Buffer.
+   */
+  void AddAtEnd (const std::vector<Buffer> &buffers);
   /**
    * \param start size to remove
    *
@@ -521,6 +560,17 @@ private:
 
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * \return the number of buffer allocations served by the free list of
+   *         the calling thread
+   */
+  static uint64_t GetFreeListHits (void);
+  /**
+   * \return the number of buffer allocations of the calling thread which
+   *         could not be served by its free list
+   */
+  static uint64_t GetFreeListMisses (void);
+
   inline Buffer (Buffer const &o);
   Buffer &operator = (Buffer const &o);
   Buffer ();
@@ -570,10 +620,22 @@ private:
   void Initialize (uint32_t zeroSize);
   uint32_t GetInternalSize (void) const;
   uint32_t GetInternalEnd (void) const;
+  /* give this buffer its own copy of its real bytes, the zero area
+   * stays virtual
+   */
+  void Unshare (void);
+  /* append size bytes of o, starting at start */
+  void AddAtEnd (const Buffer &o, uint32_t start, uint32_t size);
+  /* make room for end real bytes after the end of this buffer, in
+   * data which is not shared
+   */
+  void Reserve (uint32_t end);
   static void Recycle (struct Buffer::Data *data);
   static struct Buffer::Data *Create (uint32_t size);
   static struct Buffer::Data *Allocate (uint32_t reqSize);
   static void Deallocate (struct Buffer::Data *data);
+  /* the size of the allocation holding dataSize bytes */
+  static uint32_t GetAllocationSize (uint32_t dataSize);
 
   struct Data *m_data;
 
@@ -617,9 +679,15 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize;
-  static FreeList *g_freeList;
+  static BUFFER_THREAD_LOCAL uint32_t g_maxSize;
+  static BUFFER_THREAD_LOCAL FreeList *g_freeList;
+  static BUFFER_THREAD_LOCAL uint64_t g_freeListHits;
+  static BUFFER_THREAD_LOCAL uint64_t g_freeListMisses;
   static struct LocalStaticDestructor g_localStaticDestructor;
+  static void CreateFreeList (void);
+  /* destroy the free list of the calling thread, also when it exits */
+  static void DestroyFreeList (void *);
+  static void CreateFreeListKey (void);
 #endif
 };
 
@@ -56,6 +56,12 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 }
 #endif /* USE_FREE_LIST */
 
+static uint32_t
+GetTypeMask (TypeId tid)
+{
+  return 1U << (tid.GetUid () % 32);
+}
+
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
 {
@@ -118,12 +124,14 @@ ByteTagList::Iterator::GetOffsetStart (void) const
 
 ByteTagList::ByteTagList ()
   : m_used (0),
+    m_types (0),
     m_data (0)
 {
   NS_LOG_FUNCTION (this);
 }
 ByteTagList::ByteTagList (const ByteTagList &o)
   : m_used (o.m_used),
+    m_types (o.m_types),
     m_data (o.m_data)
 {
   NS_LOG_FUNCTION (this << &o);
@@ -144,6 +152,7 @@ ByteTagList::operator = (const ByteTagList &o)
   Deallocate (m_data);
   m_data = o.m_data;
   m_used = o.m_used;
+  m_types = o.m_types;
   if (m_data != 0)
     {
       m_data->count++;
@@ -156,6 +165,7 @@ ByteTagList::~ByteTagList ()
   Deallocate (m_data);
   m_data = 0;
   m_used = 0;
+  m_types = 0;
 }
 
 TagBuffer
@@ -185,6 +195,7 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   tag.WriteU32 (end);
   m_used = spaceNeeded;
   m_data->dirty = m_used;
+  m_types |= GetTypeMask (tid);
   return tag;
 }
 
@@ -208,6 +219,88 @@ ByteTagList::RemoveAll (void)
   Deallocate (m_data);
   m_data = 0;
   m_used = 0;
+  m_types = 0;
+}
+
+bool
+ByteTagList::MayContain (TypeId tid) const
+{
+  return (m_types & GetTypeMask (tid)) != 0;
+}
+
+uint32_t
+ByteTagList::Remove (TypeId tid)
+{
+  NS_LOG_FUNCTION (this << tid);
+  if (!MayContain (tid))
+    {
+      return 0;
+    }
+  uint32_t removed = 0;
+  ByteTagList list;
+  ByteTagList::Iterator i = BeginAll ();
+  while (i.HasNext ())
+    {
+      ByteTagList::Iterator::Item item = i.Next ();
+      if (item.tid == tid)
+        {
+          removed++;
+          continue;
+        }
+      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
+      buf.CopyFrom (item.buf);
+    }
+  if (removed != 0)
+    {
+      *this = list;
+    }
+  return removed;
+}
+
+TagBuffer
+ByteTagList::Replace (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
+{
+  NS_LOG_FUNCTION (this << tid << bufferSize << start << end);
+  uint32_t matches = 0;
+  uint32_t offset = 0;
+  bool sameSize = false;
+  if (MayContain (tid))
+    {
+      uint32_t current = 0;
+      while (current < m_used)
+        {
+          TagBuffer buf = TagBuffer (&m_data->data[current], &m_data->data[m_used]);
+          uint32_t uid = buf.ReadU32 ();
+          uint32_t size = buf.ReadU32 ();
+          if (uid == tid.GetUid ())
+            {
+              matches++;
+              offset = current;
+              sameSize = (size == bufferSize);
+            }
+          current += 4 + 4 + 4 + 4 + size;
+        }
+    }
+  if (matches != 1 || !sameSize)
+    {
+      Remove (tid);
+      return Add (tid, bufferSize, start, end);
+    }
+  if (m_data->count != 1)
+    {
+      struct ByteTagListData *newData = Allocate (m_used);
+      memcpy (&newData->data, &m_data->data, m_used);
+      newData->dirty = m_used;
+      Deallocate (m_data);
+      m_data = newData;
+    }
+  TagBuffer tag = TagBuffer (&m_data->data[offset], 
+                             &m_data->data[offset + 4 + 4 + 4 + 4 + bufferSize]);
+  tag.WriteU32 (tid.GetUid ());
+  tag.WriteU32 (bufferSize);
+  tag.WriteU32 (start);
+  tag.WriteU32 (end);
+  return tag;
 }
 
 ByteTagList::Iterator 
@@ -64,6 +64,10 @@ struct ByteTagListData;
  *     either the next call to Packet::AddHeader or Packet::AddTrailer or when
  *     the user iterates the tag list with Packet::GetTagIterator and 
  *     TagIterator::Next.
+ *
+ *   - each instance keeps a 32 bit mask of the uids (modulo 32) of the
+ *     types of the tags it holds so that looking for a type which is not
+ *     there does not require walking the tag buffer.
  */
 class ByteTagList
 {
@@ -127,6 +131,38 @@ private:
 
   void RemoveAll (void);
 
+  /**
+   * \param tid a tag type
+   * \returns false if this list holds no tag of this type, true if it
+   *          might hold one.
+   *
+   * This is a constant time check against the mask of the types added to
+   * this list: a true return value must be confirmed by iterating the list.
+   */
+  bool MayContain (TypeId tid) const;
+
+  /**
+   * \param tid the typeid of the tags to remove
+   * \returns the number of tags removed
+   *
+   * Remove all the tags of this type, whatever the bytes they cover.
+   */
+  uint32_t Remove (TypeId tid);
+
+  /**
+   * \param tid the typeid of the tag added
+   * \param bufferSize the size of the tag when its serialization will 
+   *        be completed. Typically, the return value of Tag::GetSerializedSize
+   * \param start offset which uniquely identifies the first byte tagged by this tag.
+   * \param end offset which uniquely identifies the last byte tagged by this tag.
+   * \returns a buffer which can be used to write the tag data.
+   *
+   * Same as Remove followed by Add but, if this list holds a single tag of
+   * this type with the same size, that tag is overwritten in place rather
+   * than appended again.
+   */
+  TagBuffer Replace (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end);
+
   /**
    * \param offsetStart the offset which uniquely identifies the first data byte 
    *        present in the byte buffer associated to this ByteTagList.
@@ -162,6 +198,7 @@ private:
   void Deallocate (struct ByteTagListData *data);
 
   uint16_t m_used;
+  uint32_t m_types;
   struct ByteTagListData *m_data;
 };
 
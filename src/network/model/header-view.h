@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HEADER_VIEW_H
+#define HEADER_VIEW_H
+
+#include <stdint.h>
+#include "ns3/assert.h"
+#include "packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Read-only access to the bytes of a header stored in a packet
+ *
+ * A view reads the fields of a header straight from the packet bytes
+ * rather than deserializing a Header object. When the header bytes are
+ * contiguous, the view points to them; otherwise, they are copied once
+ * into the view. Subclasses provide typed accessors for a given header.
+ *
+ * A view is invalidated by any change to the packet it was created from.
+ */
+class HeaderView
+{
+public:
+  enum {
+    /** The largest number of bytes a view can cover */
+    MAX_SIZE = 60
+  };
+
+  /**
+   * \returns true if the packet was large enough to contain the header,
+   *          false otherwise. The other accessors must not be called
+   *          when this returns false.
+   */
+  inline bool IsValid (void) const;
+
+protected:
+  /**
+   * \param packet the packet which contains the header
+   * \param offset offset of the header from the start of the packet
+   * \param size number of bytes read by the view
+   */
+  HeaderView (const Packet &packet, uint32_t offset, uint32_t size);
+
+  inline uint8_t ReadU8 (uint32_t i) const;
+  inline uint16_t ReadNtohU16 (uint32_t i) const;
+  inline uint32_t ReadNtohU32 (uint32_t i) const;
+
+private:
+  // the data may point to m_copy
+  HeaderView (const HeaderView &o);
+  HeaderView &operator = (const HeaderView &o);
+
+  uint8_t const *m_data;
+  uint8_t m_copy[MAX_SIZE];
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+bool
+HeaderView::IsValid (void) const
+{
+  return m_data != 0;
+}
+
+uint8_t
+HeaderView::ReadU8 (uint32_t i) const
+{
+  NS_ASSERT (IsValid ());
+  return m_data[i];
+}
+
+uint16_t
+HeaderView::ReadNtohU16 (uint32_t i) const
+{
+  NS_ASSERT (IsValid ());
+  return (m_data[i] << 8) | m_data[i + 1];
+}
+
+uint32_t
+HeaderView::ReadNtohU32 (uint32_t i) const
+{
+  NS_ASSERT (IsValid ());
+  return ((uint32_t)m_data[i] << 24) | (m_data[i + 1] << 16) |
+         (m_data[i + 2] << 8) | m_data[i + 3];
+}
+
+} // namespace ns3
+
+#endif /* HEADER_VIEW_H */
@@ -31,6 +31,7 @@
 #include "ns3/global-value.h"
 #include "ns3/boolean.h"
 #include "ns3/simulator.h"
+#include "ns3/memory-accounting.h"
 
 NS_LOG_COMPONENT_DEFINE ("Node");
 
@@ -109,6 +110,10 @@ Node::AddDevice (Ptr<NetDevice> device)
   m_devices.push_back (device);
   device->SetNode (this);
   device->SetIfIndex (index);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::SetContext (static_cast<ObjectBase *> (PeekPointer (device)), GetId ());
+    }
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Start, device);
@@ -134,6 +139,10 @@ Node::AddApplication (Ptr<Application> application)
   uint32_t index = m_applications.size ();
   m_applications.push_back (application);
   application->SetNode (this);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::SetContext (static_cast<ObjectBase *> (PeekPointer (application)), GetId ());
+    }
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &Application::Start, application);
   return index;
@@ -193,6 +202,23 @@ Node::DoStart (void)
   Object::DoStart ();
 }
 
+void
+Node::NotifyNewAggregate (void)
+{
+  if (MemoryAccounting::IsEnabled ())
+    {
+      // the node and its aggregates are usually created while the
+      // simulation is set up, outside of the context of the node
+      AggregateIterator i = GetAggregateIterator ();
+      while (i.HasNext ())
+        {
+          Ptr<const Object> object = i.Next ();
+          MemoryAccounting::SetContext (static_cast<const ObjectBase *> (PeekPointer (object)), GetId ());
+        }
+    }
+  Object::NotifyNewAggregate ();
+}
+
 void
 Node::RegisterProtocolHandler (ProtocolHandler handler, 
                                uint16_t protocolType,
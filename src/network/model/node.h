@@ -208,6 +208,7 @@ protected:
    */
   virtual void DoDispose (void);
   virtual void DoStart (void);
+  virtual void NotifyNewAggregate (void);
 private:
   void NotifyDeviceAdded (Ptr<NetDevice> device);
   bool NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet>, uint16_t protocol, const Address &from);
@@ -19,9 +19,12 @@
  */
 #include <utility>
 #include <list>
+#include <set>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -33,30 +36,20 @@ namespace ns3 {
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
+bool PacketMetadata::m_enableContexts = false;
+uint32_t PacketMetadata::m_sizeLimit = 0xffff;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
+namespace {
+// the contexts selected with PacketMetadata::EnableContext
+std::set<uint32_t> g_contexts;
+} // anonymous namespace
 
 void 
 PacketMetadata::Enable (void)
 {
-  NS_ASSERT_MSG (!m_metadataSkipped,
-                 "Error: attempting to enable the packet metadata "
-                 "subsystem too late in the simulation, which is not allowed.\n"
-                 "A common cause for this problem is to enable ASCII tracing "
-                 "after sending any packets.  One way to fix this problem is "
-                 "to call ns3::PacketMetadata::Enable () near the beginning of"
-                 " the program, before any packets are sent.");
+  // the packets created before this call simply do not record
+  // their metadata
   m_enable = true;
 }
 
@@ -67,6 +60,77 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableContext (uint32_t context)
+{
+  NS_LOG_FUNCTION (context);
+  g_contexts.insert (context);
+  m_enableContexts = true;
+}
+
+void
+PacketMetadata::SetSizeLimit (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+  m_sizeLimit = std::min<uint32_t> (size, 0xffff);
+}
+
+bool
+PacketMetadata::IsContextEnabled (void)
+{
+  return g_contexts.find (Simulator::GetContext ()) != g_contexts.end ();
+}
+
+void
+PacketMetadata::Initialize (uint32_t size)
+{
+  m_data = PacketMetadata::Create (10);
+  memset (m_data->m_data, 0xff, 4);
+  if (size > 0)
+    {
+      DoAddHeader (0, size);
+    }
+}
+
+void
+PacketMetadata::EnableRecording (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_data == 0)
+    {
+      Initialize (size);
+    }
+}
+
+void
+PacketMetadata::Discard (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return;
+    }
+  m_data->m_count--;
+  if (m_data->m_count == 0)
+    {
+      PacketMetadata::Recycle (m_data);
+    }
+  m_data = 0;
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+}
+
+void
+PacketMetadata::CheckSizeLimit (void)
+{
+  if (m_used > m_sizeLimit)
+    {
+      NS_LOG_LOGIC ("metadata of packet " << m_packetUid << " is too large, dropping it");
+      Discard ();
+    }
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -125,6 +189,10 @@ PacketMetadata::IsPointerOk (uint16_t pointer) const
 bool
 PacketMetadata::IsStateOk (void) const
 {
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff && m_used == 0;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -562,6 +630,31 @@ PacketMetadata::ReadItems (uint16_t current,
   return buffer - &m_data->m_data[current];
 }
 
+#ifdef BUFFER_FREE_LIST
+// see the comment in buffer.cc which explains these three states
+#define MAGIC_DESTROYED (~(long) 0)
+#define IS_UNINITIALIZED(x) (x == (PacketMetadata::FreeList*)0)
+#define IS_DESTROYED(x) (x == (PacketMetadata::FreeList*)MAGIC_DESTROYED)
+#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
+#define DESTROYED ((PacketMetadata::FreeList*)MAGIC_DESTROYED)
+BUFFER_THREAD_LOCAL uint32_t PacketMetadata::m_maxSize = 0;
+BUFFER_THREAD_LOCAL PacketMetadata::FreeList *PacketMetadata::m_freeList = 0;
+struct PacketMetadata::LocalStaticDestructor PacketMetadata::m_localStaticDestructor;
+
+PacketMetadata::LocalStaticDestructor::~LocalStaticDestructor (void)
+{
+  if (IS_INITIALIZED (m_freeList))
+    {
+      for (PacketMetadata::FreeList::iterator i = m_freeList->begin ();
+           i != m_freeList->end (); i++)
+        {
+          PacketMetadata::Deallocate (*i);
+        }
+      delete m_freeList;
+      m_freeList = DESTROYED;
+    }
+}
+
 struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
@@ -570,18 +663,25 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  if (IS_UNINITIALIZED (m_freeList))
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
+      m_freeList = new PacketMetadata::FreeList ();
+    }
+  else if (IS_INITIALIZED (m_freeList))
+    {
+      while (!m_freeList->empty ()) 
         {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
+          struct PacketMetadata::Data *data = m_freeList->back ();
+          m_freeList->pop_back ();
+          if (data->m_size >= size) 
+            {
+              NS_LOG_LOGIC ("create found size="<<data->m_size);
+              data->m_count = 1;
+              return data;
+            }
+          PacketMetadata::Deallocate (data);
+          NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
         }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
     }
   NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
   return PacketMetadata::Allocate (m_maxSize);
@@ -590,23 +690,37 @@ PacketMetadata::Create (uint32_t size)
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
+  /* the metadata may have been created by another thread */
+  if (IS_UNINITIALIZED (m_freeList))
+    {
+      m_freeList = new PacketMetadata::FreeList ();
+    }
+  if (IS_DESTROYED (m_freeList) ||
+      m_freeList->size () > 1000 ||
       data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
-      m_freeList.push_back (data);
+      m_freeList->push_back (data);
     }
 }
+#else /* BUFFER_FREE_LIST */
+struct PacketMetadata::Data *
+PacketMetadata::Create (uint32_t size)
+{
+  return PacketMetadata::Allocate (size);
+}
+
+void
+PacketMetadata::Recycle (struct PacketMetadata::Data *data)
+{
+  NS_ASSERT (data->m_count == 0);
+  PacketMetadata::Deallocate (data);
+}
+#endif /* BUFFER_FREE_LIST */
 
 struct PacketMetadata::Data *
 PacketMetadata::Allocate (uint32_t n)
@@ -647,15 +761,15 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
   NS_ASSERT (IsStateOk ());
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   DoAddHeader (uid, size);
+  CheckSizeLimit ();
   NS_ASSERT (IsStateOk ());
 }
 void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
 
@@ -675,9 +789,8 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << uid << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -723,9 +836,8 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << uid << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -737,6 +849,7 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   m_chunkUid++;
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
+  CheckSizeLimit ();
   NS_ASSERT (IsStateOk ());
 }
 void 
@@ -745,9 +858,8 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << uid << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -792,9 +904,15 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
+    {
+      return;
+    }
+  if (o.m_data == 0)
     {
-      m_metadataSkipped = true;
+      // the metadata of the other packet is unknown so, we
+      // cannot describe the aggregate
+      Discard ();
       return;
     }
   if (m_tail == 0xffff)
@@ -839,6 +957,7 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       if (o.m_head == o.m_tail)
         {
           // there is only one item to append to self from other.
+          CheckSizeLimit ();
           return;
         }
       current = item.next;
@@ -863,14 +982,14 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
         }
       current = item.next;
     }
+  CheckSizeLimit ();
   NS_ASSERT (IsStateOk ());
 }
 void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
-  if (!m_enable)
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
 }
@@ -879,12 +998,10 @@ PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
@@ -911,6 +1028,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.EnableRecording (0);
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -942,12 +1060,10 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
-      m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
   uint16_t current = m_tail;
@@ -975,6 +1091,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.EnableRecording (0);
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1128,7 +1245,7 @@ PacketMetadata::GetSerializedSize (void) const
   // if packet-metadata not enabled, total size
   // is simply 4-bytes for itself plus 8-bytes 
   // for packet uid
-  if (!m_enable)
+  if (m_data == 0)
     {
       return totalSize;
     }
@@ -1271,6 +1388,10 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
+  if (desSize > 0)
+    {
+      EnableRecording (0);
+    }
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -75,6 +75,14 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * A packet which does not record its metadata does not allocate any
+ * data buffer. Metadata can be recorded for every packet (Enable), for
+ * the packets created in selected simulation contexts (EnableContext),
+ * or for individual packets (EnableRecording). Recording stops, and the
+ * metadata of a packet is dropped, when its data buffer would grow beyond
+ * the limit set with SetSizeLimit. The data buffers are recycled through
+ * a per-thread free list.
  */
 class PacketMetadata 
 {
@@ -127,12 +135,39 @@ private:
 
   static void Enable (void);
   static void EnableChecking (void);
+  /**
+   * \param context a simulation context, typically a node id
+   *
+   * Record the metadata of the packets created while the simulator
+   * runs events in this context. This can be called at any time: it
+   * applies to the packets created afterwards.
+   */
+  static void EnableContext (uint32_t context);
+  /**
+   * \param size a number of bytes
+   *
+   * The metadata of a packet is dropped when it does not fit in this
+   * number of bytes anymore. The default is the largest supported size.
+   */
+  static void SetSizeLimit (uint32_t size);
 
   inline PacketMetadata (uint64_t uid, uint32_t size);
   inline PacketMetadata (PacketMetadata const &o);
   inline PacketMetadata &operator = (PacketMetadata const& o);
   inline ~PacketMetadata ();
 
+  /**
+   * \param size the current size of the packet
+   *
+   * Start recording the metadata of this packet if it was not already.
+   * The bytes already present in the packet are recorded as payload.
+   */
+  void EnableRecording (uint32_t size);
+  /**
+   * \returns true if this packet records its metadata, false otherwise.
+   */
+  inline bool IsRecording (void) const;
+
   void AddHeader (Header const &header, uint32_t size);
   void RemoveHeader (Header const &header, uint32_t size);
 
@@ -292,17 +327,15 @@ private:
     uint64_t packetUid;
   };
 
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
 
+  static bool IsContextEnabled (void);
+  void Initialize (uint32_t size);
+  void Discard (void);
+  void CheckSizeLimit (void);
+
   inline uint16_t AddSmall (const PacketMetadata::SmallItem *item);
   uint16_t AddBig (uint32_t head, uint32_t tail,
                    const PacketMetadata::SmallItem *item, 
@@ -335,18 +368,26 @@ public:
   static struct PacketMetadata::Data *Allocate (uint32_t n);
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList;
+#ifdef BUFFER_FREE_LIST
+  typedef std::vector<struct PacketMetadata::Data *> FreeList;
+  struct LocalStaticDestructor 
+  {
+    ~LocalStaticDestructor ();
+  };
+  static BUFFER_THREAD_LOCAL uint32_t m_maxSize;
+  static BUFFER_THREAD_LOCAL FreeList *m_freeList;
+  static struct LocalStaticDestructor m_localStaticDestructor;
+#endif
+
   static bool m_enable;
   static bool m_enableChecking;
+  // true once EnableContext has been called
+  static bool m_enableContexts;
+  static uint32_t m_sizeLimit;
 
-  // set to true when adding metadata to a packet is skipped because
-  // m_enable is false; used to detect enabling of metadata in the
-  // middle of a simulation, which isn't allowed.
-  static bool m_metadataSkipped;
-
-  static uint32_t m_maxSize;
   static uint16_t m_chunkUid;
 
+  // zero if this packet does not record its metadata
   struct Data *m_data;
   /**
      head -(next)-> tail
@@ -364,16 +405,15 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
-  if (size > 0)
+  if (m_enable || (m_enableContexts && IsContextEnabled ()))
     {
-      DoAddHeader (0, size);
+      Initialize (size);
     }
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
@@ -383,9 +423,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -393,15 +435,19 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -411,7 +457,10 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -419,6 +468,12 @@ PacketMetadata::~PacketMetadata ()
     }
 }
 
+bool
+PacketMetadata::IsRecording (void) const
+{
+  return m_data != 0;
+}
+
 } // namespace ns3
 
 
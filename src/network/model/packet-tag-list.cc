@@ -22,110 +22,99 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <algorithm>
 #include <string.h>
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
 namespace ns3 {
 
-#ifdef USE_FREE_LIST
-
-struct PacketTagList::TagData *PacketTagList::g_free = 0;
-uint32_t PacketTagList::g_nfree = 0;
+struct PacketTagList::TagArray *
+PacketTagList::Allocate (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (capacity);
+  uint8_t *buffer = new uint8_t [sizeof (struct TagArray) + (capacity - 1) * sizeof (struct TagData)];
+  struct TagArray *array = (struct TagArray *)buffer;
+  array->count = 1;
+  array->capacity = capacity;
+  return array;
+}
 
-struct PacketTagList::TagData *
-PacketTagList::AllocData (void) const
+void
+PacketTagList::Deallocate (struct TagArray *array)
 {
-  NS_LOG_FUNCTION (g_nfree);
-  struct PacketTagList::TagData *retval;
-  if (g_free != 0) 
+  NS_LOG_FUNCTION (array);
+  array->count--;
+  if (array->count == 0)
     {
-      retval = g_free;
-      g_free = g_free->m_next;
-      g_nfree--;
-    } 
-  else 
-    {
-      retval = new struct PacketTagList::TagData ();
+      uint8_t *buffer = (uint8_t *)array;
+      delete [] buffer;
     }
-  return retval;
 }
 
 void
-PacketTagList::FreeData (struct TagData *data) const
+PacketTagList::Unshare (uint32_t capacity)
 {
-  NS_LOG_FUNCTION (g_nfree << data);
-  if (g_nfree > 1000) 
+  NS_LOG_FUNCTION (this << capacity);
+  if (m_array != 0 && m_array->count == 1 && m_array->capacity >= capacity)
     {
-      delete data;
       return;
     }
-  g_nfree++;
-  data->next = g_free;
-  data->tid = TypeId ();
-  g_free = data;
-}
-#else
-struct PacketTagList::TagData *
-PacketTagList::AllocData (void) const
-{
-  NS_LOG_FUNCTION_NOARGS ();
-  struct PacketTagList::TagData *retval;
-  retval = new struct PacketTagList::TagData ();
-  return retval;
+  struct TagArray *array = Allocate (std::max (capacity, 2 * m_size));
+  memcpy (array->tags, GetTags (), m_size * sizeof (struct TagData));
+  if (m_array != 0)
+    {
+      Deallocate (m_array);
+    }
+  m_array = array;
 }
 
-void
-PacketTagList::FreeData (struct TagData *data) const
+struct PacketTagList::TagData *
+PacketTagList::Find (TypeId tid) const
 {
-  NS_LOG_FUNCTION (data);
-  delete data;
+  struct TagData *tags = GetTags ();
+  uint16_t uid = tid.GetUid ();
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      if (tags[i].tid == uid)
+        {
+          return &tags[i];
+        }
+    }
+  return 0;
 }
-#endif
 
 bool
 PacketTagList::Remove (Tag &tag)
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  TypeId tid = tag.GetInstanceTypeId ();
-  bool found = false;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  struct TagData *data = Find (tag.GetInstanceTypeId ());
+  if (data == 0)
     {
-      if (cur->tid == tid) 
-        {
-          found = true;
-          tag.Deserialize (TagBuffer (cur->data, cur->data+PACKET_TAG_MAX_SIZE));
-        }
+      return false;
     }
-  if (!found) 
+  tag.Deserialize (TagBuffer (data->data, data->data+PACKET_TAG_MAX_SIZE));
+  struct TagData *tags = GetTags ();
+  uint32_t index = data - tags;
+  uint32_t after = m_size - index - 1;
+  if (m_array == 0)
     {
-      return false;
+      memmove (&m_inline[index], &m_inline[index + 1], after * sizeof (struct TagData));
     }
-  struct TagData *start = 0;
-  struct TagData **prevNext = &start;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  else if (m_size - 1 <= INLINE_SIZE)
     {
-      if (cur->tid == tid) 
-        {
-          /**
-           * XXX
-           * Note: I believe that we could optimize this to
-           * avoid copying each TagData located after the target id
-           * and just link the already-copied list to the next tag.
-           */
-          continue;
-        }
-      struct TagData *copy = AllocData ();
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->next = 0;
-      memcpy (copy->data, cur->data, PACKET_TAG_MAX_SIZE);
-      *prevNext = copy;
-      prevNext = &copy->next;
+      // move back to the inline storage
+      memcpy (m_inline, tags, index * sizeof (struct TagData));
+      memcpy (&m_inline[index], &tags[index + 1], after * sizeof (struct TagData));
+      Deallocate (m_array);
+      m_array = 0;
     }
-  *prevNext = 0;
-  RemoveAll ();
-  m_next = start;
+  else
+    {
+      Unshare (m_size);
+      memmove (&m_array->tags[index], &m_array->tags[index + 1], after * sizeof (struct TagData));
+    }
+  m_size--;
   return true;
 }
 
@@ -134,43 +123,31 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_ASSERT (Find (tag.GetInstanceTypeId ()) == 0);
+  NS_ASSERT (tag.GetSerializedSize () <= PACKET_TAG_MAX_SIZE);
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  if (m_array != 0 || m_size == INLINE_SIZE)
     {
-      NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
+      self->Unshare (m_size + 1);
     }
-  struct TagData *head = AllocData ();
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= PACKET_TAG_MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data+tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  struct TagData *data = &GetTags ()[m_size];
+  data->tid = tag.GetInstanceTypeId ().GetUid ();
+  tag.Serialize (TagBuffer (data->data, data->data+tag.GetSerializedSize ()));
+  self->m_size++;
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  struct TagData *data = Find (tag.GetInstanceTypeId ());
+  if (data == 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data+PACKET_TAG_MAX_SIZE));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
-}
-
-const struct PacketTagList::TagData *
-PacketTagList::Head (void) const
-{
-  return m_next;
+  tag.Deserialize (TagBuffer (data->data, data->data+PACKET_TAG_MAX_SIZE));
+  return true;
 }
 
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define PACKET_TAG_LIST_H
 
 #include <stdint.h>
+#include <string.h>
 #include <ostream>
 #include "ns3/type-id.h"
 
@@ -36,14 +37,28 @@ class Tag;
  */
 #define PACKET_TAG_MAX_SIZE 20
 
+/**
+ * \ingroup packet
+ *
+ * \brief keep track of the packet tags stored in a packet.
+ *
+ * The tags are stored in a contiguous array. Up to three of them are kept
+ * within the list itself so that adding, removing and looking up the tags
+ * of the common packet which carries a few of them never allocates memory.
+ * Beyond that, the tags move to a reference-counted heap array which is
+ * shared between copies of the list and unshared as-needed to emulate COW
+ * semantics.
+ */
 class PacketTagList 
 {
 public:
+  /**
+   * The tags are copied and moved as raw bytes so they hold the uid of
+   * their TypeId rather than the TypeId itself.
+   */
   struct TagData {
     uint8_t data[PACKET_TAG_MAX_SIZE];
-    struct TagData *next;
-    TypeId tid;
-    uint32_t count;
+    uint16_t tid;
   };
 
   inline PacketTagList ();
@@ -56,18 +71,36 @@ public:
   bool Peek (Tag &tag) const;
   inline void RemoveAll (void);
 
-  const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns the first tag of this list. The following ones are stored
+   *          contiguously up to End. Both pointers are invalidated by any
+   *          change to this list.
+   */
+  inline const struct PacketTagList::TagData *Begin (void) const;
+  /**
+   * \returns the location past the last tag of this list.
+   */
+  inline const struct PacketTagList::TagData *End (void) const;
 
 private:
+  enum {
+    INLINE_SIZE = 3
+  };
+  struct TagArray {
+    uint32_t count;
+    uint32_t capacity;
+    struct TagData tags[1];
+  };
 
-  bool Remove (TypeId tid);
-  struct PacketTagList::TagData *AllocData (void) const;
-  void FreeData (struct TagData *data) const;
-
-  static struct PacketTagList::TagData *g_free;
-  static uint32_t g_nfree;
+  inline struct PacketTagList::TagData *GetTags (void) const;
+  struct PacketTagList::TagData *Find (TypeId tid) const;
+  void Unshare (uint32_t capacity);
+  static struct PacketTagList::TagArray *Allocate (uint32_t capacity);
+  static void Deallocate (struct TagArray *array);
 
-  struct TagData *m_next;
+  uint32_t m_size;
+  struct TagArray *m_array;
+  struct TagData m_inline[INLINE_SIZE];
 };
 
 } // namespace ns3
@@ -79,16 +112,22 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_size (0),
+    m_array (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_size (o.m_size),
+    m_array (o.m_array)
 {
-  if (m_next != 0)
+  if (m_array != 0)
+    {
+      m_array->count++;
+    }
+  else
     {
-      m_next->count++;
+      memcpy (m_inline, o.m_inline, m_size * sizeof (struct TagData));
     }
 }
 
@@ -96,15 +135,20 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_size = o.m_size;
+  m_array = o.m_array;
+  if (m_array != 0) 
     {
-      m_next->count++;
+      m_array->count++;
+    }
+  else
+    {
+      memcpy (m_inline, o.m_inline, m_size * sizeof (struct TagData));
     }
   return *this;
 }
@@ -117,25 +161,34 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  if (m_array != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-          FreeData (prev);
-        }
-      prev = cur;
+      Deallocate (m_array);
+      m_array = 0;
     }
-  if (prev != 0) 
+  m_size = 0;
+}
+
+struct PacketTagList::TagData *
+PacketTagList::GetTags (void) const
+{
+  if (m_array != 0)
     {
-      FreeData (prev);
+      return m_array->tags;
     }
-  m_next = 0;
+  return const_cast<struct TagData *> (m_inline);
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::Begin (void) const
+{
+  return GetTags ();
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::End (void) const
+{
+  return GetTags () + m_size;
 }
 
 } // namespace ns3
@@ -21,8 +21,13 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/memory-accounting.h"
 #include <string>
 #include <stdarg.h>
+#include <algorithm>
+#ifdef BUFFER_FREE_LIST_KEY
+#include <pthread.h>
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
@@ -30,6 +35,148 @@ namespace ns3 {
 
 uint32_t Packet::m_globalUid = 0;
 
+namespace {
+// the packets appended by AddAtEnd are referenced rather than copied from this size
+const uint32_t SEGMENT_MIN_SIZE = 128;
+} // anonymous namespace
+
+#ifdef BUFFER_FREE_LIST
+namespace {
+
+struct FreePacket
+{
+  struct FreePacket *next;
+};
+
+const uint32_t PACKET_FREE_LIST_SIZE = 1000;
+
+BUFFER_THREAD_LOCAL struct FreePacket *g_freePackets = 0;
+BUFFER_THREAD_LOCAL uint32_t g_nFreePackets = 0;
+BUFFER_THREAD_LOCAL uint64_t g_packetHits = 0;
+BUFFER_THREAD_LOCAL uint64_t g_packetMisses = 0;
+// set once the free list of the main thread has been released at exit
+bool g_freePacketsDestroyed = false;
+
+void
+DeleteFreePackets (void)
+{
+  while (g_freePackets != 0)
+    {
+      struct FreePacket *packet = g_freePackets;
+      g_freePackets = packet->next;
+      ::operator delete (packet);
+    }
+  g_nFreePackets = 0;
+}
+
+#ifdef BUFFER_FREE_LIST_KEY
+// the free lists of the other threads are released when they exit
+pthread_key_t g_freePacketsKey;
+pthread_once_t g_freePacketsKeyOnce = PTHREAD_ONCE_INIT;
+BUFFER_THREAD_LOCAL bool g_freePacketsKeySet = false;
+
+void
+DeleteFreePacketsAtExit (void *)
+{
+  DeleteFreePackets ();
+  // packets freed by later destructors register the list again
+  g_freePacketsKeySet = false;
+}
+
+void
+CreateFreePacketsKey (void)
+{
+  pthread_key_create (&g_freePacketsKey, &DeleteFreePacketsAtExit);
+}
+#endif /* BUFFER_FREE_LIST_KEY */
+
+static class FreePacketsDestructor
+{
+public:
+  ~FreePacketsDestructor ()
+  {
+    DeleteFreePackets ();
+    g_freePacketsDestroyed = true;
+  }
+} g_freePacketsDestructor;
+
+} // anonymous namespace
+
+void *
+Packet::operator new (size_t size)
+{
+  // subclasses do not have the same size
+  if (size == sizeof (Packet) && g_freePackets != 0)
+    {
+      struct FreePacket *packet = g_freePackets;
+      g_freePackets = packet->next;
+      g_nFreePackets--;
+      g_packetHits++;
+      return packet;
+    }
+  g_packetMisses++;
+  return ::operator new (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  if (size != sizeof (Packet) ||
+      g_nFreePackets >= PACKET_FREE_LIST_SIZE ||
+      g_freePacketsDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  struct FreePacket *packet = static_cast<struct FreePacket *> (p);
+  packet->next = g_freePackets;
+  g_freePackets = packet;
+  g_nFreePackets++;
+#ifdef BUFFER_FREE_LIST_KEY
+  if (!g_freePacketsKeySet)
+    {
+      pthread_once (&g_freePacketsKeyOnce, &CreateFreePacketsKey);
+      pthread_setspecific (g_freePacketsKey, &g_freePacketsKeySet);
+      g_freePacketsKeySet = true;
+    }
+#endif
+}
+
+Packet::PoolStatistics
+Packet::GetPoolStatistics (void)
+{
+  PoolStatistics statistics;
+  statistics.packetHits = g_packetHits;
+  statistics.packetMisses = g_packetMisses;
+  statistics.bufferHits = Buffer::GetFreeListHits ();
+  statistics.bufferMisses = Buffer::GetFreeListMisses ();
+  return statistics;
+}
+#else /* BUFFER_FREE_LIST */
+void *
+Packet::operator new (size_t size)
+{
+  return ::operator new (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  ::operator delete (p);
+}
+
+Packet::PoolStatistics
+Packet::GetPoolStatistics (void)
+{
+  PoolStatistics statistics;
+  statistics.packetHits = 0;
+  statistics.packetMisses = 0;
+  statistics.bufferHits = 0;
+  statistics.bufferMisses = 0;
+  return statistics;
+}
+#endif /* BUFFER_FREE_LIST */
+
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
 {
@@ -81,21 +228,23 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *begin,
+                                      const struct PacketTagList::TagData *end)
+  : m_current (begin),
+    m_end (end)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_end;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
   const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
+  m_current++;
   return PacketTagIterator::Item (prev);
 }
 
@@ -106,12 +255,14 @@ PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  TypeId tid;
+  tid.SetUid (m_data->tid);
+  return tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
+  NS_ASSERT (tag.GetInstanceTypeId ().GetUid () == m_data->tid);
   tag.Deserialize (TagBuffer ((uint8_t*)m_data->data, (uint8_t*)m_data->data+PACKET_TAG_MAX_SIZE));
 }
 
@@ -136,19 +287,38 @@ Packet::Packet ()
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_segmentsSize (0)
 {
   m_globalUid++;
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_segments (o.m_segments),
+    m_segmentsSize (o.m_segmentsSize)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
+}
+
+Packet::~Packet ()
+{
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Free (this);
+    }
 }
 
 Packet &
@@ -162,6 +332,8 @@ Packet::operator = (const Packet &o)
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
+  m_segments = o.m_segments;
+  m_segmentsSize = o.m_segmentsSize;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
   return *this;
@@ -178,19 +350,29 @@ Packet::Packet (uint32_t size)
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_segmentsSize (0)
 {
   m_globalUid++;
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
     m_byteTagList (),
     m_packetTagList (),
     m_metadata (0,0),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_segmentsSize (0)
 {
   NS_ASSERT (magic);
   Deserialize (buffer, size);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
 }
 
 Packet::Packet (uint8_t const*buffer, uint32_t size)
@@ -204,12 +386,17 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * global UID
      */
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_segmentsSize (0)
 {
   m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
@@ -218,21 +405,66 @@ Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList,
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
     m_metadata (metadata),
-    m_nixVector (0)
+    m_nixVector (0),
+    m_segmentsSize (0)
 {
+  if (MemoryAccounting::IsEnabled ())
+    {
+      MemoryAccounting::Allocate (this, "ns3::Packet", sizeof (Packet));
+    }
 }
 
 Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
   NS_LOG_FUNCTION (this << start << length);
-  Buffer buffer = m_buffer.CreateFragment (start, length);
-  NS_ASSERT (m_buffer.GetSize () >= start + length);
-  uint32_t end = m_buffer.GetSize () - (start + length);
+  NS_ASSERT (GetSize () >= start + length);
+  uint32_t end = GetSize () - (start + length);
   PacketMetadata metadata = m_metadata.CreateFragment (start, end);
-  // again, call the constructor directly rather than
-  // through Create because it is private.
-  return Ptr<Packet> (new Packet (buffer, m_byteTagList, m_packetTagList, metadata), false);
+  if (length == 0)
+    {
+      // no byte is covered, by the buffer or by any segment
+      return Ptr<Packet> (new Packet (m_buffer.CreateFragment (0, 0), ByteTagList (), m_packetTagList, metadata), false);
+    }
+  uint32_t headSize = m_buffer.GetSize ();
+  if (start + length <= headSize)
+    {
+      Buffer buffer = m_buffer.CreateFragment (start, length);
+      // again, call the constructor directly rather than
+      // through Create because it is private.
+      return Ptr<Packet> (new Packet (buffer, m_byteTagList, m_packetTagList, metadata), false);
+    }
+
+  // the fragment references slices of the buffers which it overlaps
+  std::vector<Buffer> parts;
+  // end of the first slice, in the coordinates of the byte tags
+  int32_t firstEnd = m_buffer.GetCurrentEndOffset ();
+  if (start < headSize)
+    {
+      parts.push_back (m_buffer.CreateFragment (start, headSize - start));
+    }
+  uint32_t segmentStart = headSize;
+  for (std::vector<Buffer>::const_iterator i = m_segments.begin (); i != m_segments.end (); ++i)
+    {
+      uint32_t segmentEnd = segmentStart + i->GetSize ();
+      if (segmentEnd > start && segmentStart < start + length)
+        {
+          uint32_t sliceStart = std::max (start, segmentStart);
+          uint32_t sliceEnd = std::min (start + length, segmentEnd);
+          if (parts.empty ())
+            {
+              firstEnd += sliceEnd - headSize;
+            }
+          parts.push_back (i->CreateFragment (sliceStart - segmentStart, sliceEnd - sliceStart));
+        }
+      segmentStart = segmentEnd;
+    }
+  ByteTagList byteTagList = m_byteTagList;
+  byteTagList.AddAtStart (parts[0].GetCurrentEndOffset () - firstEnd, parts[0].GetCurrentStartOffset ());
+  Ptr<Packet> fragment = Ptr<Packet> (new Packet (parts[0], byteTagList, m_packetTagList, metadata), false);
+  fragment->m_segments.assign (parts.begin () + 1, parts.end ());
+  fragment->m_segmentsSize = length - parts[0].GetSize ();
+  return fragment;
 }
 
 void
@@ -252,6 +484,8 @@ Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  // the header may read the rest of the packet, to compute a checksum
+  Gather ();
   uint32_t orgStart = m_buffer.GetCurrentStartOffset ();
   bool resized = m_buffer.AddAtStart (size);
   if (resized)
@@ -265,6 +499,7 @@ Packet::AddHeader (const Header &header)
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
+  Gather ();
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
@@ -274,15 +509,47 @@ Packet::RemoveHeader (Header &header)
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
+  Gather ();
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
+uint32_t
+Packet::RemoveHeader (Header &header, uint32_t size)
+{
+  if (size > m_buffer.GetSize ())
+    {
+      Gather ();
+    }
+  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
+  NS_ASSERT_MSG (deserialized == size, "Header of " << deserialized << " bytes instead of " << size);
+  m_buffer.RemoveAtStart (deserialized);
+  if (m_buffer.GetSize () == 0 && !m_segments.empty ())
+    {
+      PopSegment ();
+    }
+  m_metadata.RemoveHeader (header, deserialized);
+  return deserialized;
+}
+uint32_t
+Packet::PeekHeader (Header &header, uint32_t size) const
+{
+  if (size > m_buffer.GetSize ())
+    {
+      Gather ();
+    }
+  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
+  NS_ASSERT_MSG (deserialized == size, "Header of " << deserialized << " bytes instead of " << size);
+  return deserialized;
+}
 void
 Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
+  Gather ();
   uint32_t orgStart = m_buffer.GetCurrentStartOffset ();
   bool resized = m_buffer.AddAtEnd (size);
   if (resized)
@@ -297,6 +564,7 @@ Packet::AddTrailer (const Trailer &trailer)
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
 {
+  Gather ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
@@ -306,6 +574,7 @@ Packet::RemoveTrailer (Trailer &trailer)
 uint32_t
 Packet::PeekTrailer (Trailer &trailer)
 {
+  Gather ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
@@ -315,22 +584,64 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
-  uint32_t aStart = m_buffer.GetCurrentStartOffset ();
-  uint32_t bEnd = packet->m_buffer.GetCurrentEndOffset ();
-  m_buffer.AddAtEnd (packet->m_buffer);
-  uint32_t appendPrependOffset = m_buffer.GetCurrentEndOffset () - packet->m_buffer.GetSize ();
-  m_byteTagList.AddAtEnd (m_buffer.GetCurrentStartOffset () - aStart, 
-                          appendPrependOffset);
+  // packet may be this packet
+  Buffer buffer = packet->m_buffer;
   ByteTagList copy = packet->m_byteTagList;
-  copy.AddAtStart (m_buffer.GetCurrentEndOffset () - bEnd,
-                   appendPrependOffset);
-  m_byteTagList.Add (copy);
+  uint32_t size = packet->GetSize ();
+  int32_t bStart = buffer.GetCurrentStartOffset ();
+  int32_t end = GetEndOffset ();
+  if (GetSize () == 0)
+    {
+      // nothing to copy: this packet takes the buffers of the other one
+      m_buffer = buffer;
+      m_segments = packet->m_segments;
+      m_segmentsSize = packet->m_segmentsSize;
+      m_byteTagList = copy;
+    }
+  else if (size < SEGMENT_MIN_SIZE && packet->m_segments.empty ())
+    {
+      int32_t aStart = m_buffer.GetCurrentStartOffset ();
+      if (m_segments.empty ())
+        {
+          m_buffer.AddAtEnd (buffer);
+        }
+      else
+        {
+          m_segments.back ().AddAtEnd (buffer);
+          m_segmentsSize += size;
+        }
+      int32_t delta = m_buffer.GetCurrentStartOffset () - aStart;
+      end += delta;
+      m_byteTagList.AddAtEnd (delta, end);
+      copy.AddAtStart (end - bStart, end);
+      m_byteTagList.Add (copy);
+    }
+  else
+    {
+      std::vector<Buffer> segments = packet->m_segments;
+      if (buffer.GetSize () != 0)
+        {
+          m_segments.push_back (buffer);
+        }
+      m_segments.insert (m_segments.end (), segments.begin (), segments.end ());
+      m_segmentsSize += size;
+      m_byteTagList.AddAtEnd (0, end);
+      copy.AddAtStart (end - bStart, end);
+      m_byteTagList.Add (copy);
+    }
   m_metadata.AddAtEnd (packet->m_metadata);
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  if (!m_segments.empty ())
+    {
+      m_segments.back ().AddAtEnd (size);
+      m_segmentsSize += size;
+      m_metadata.AddPaddingAtEnd (size);
+      return;
+    }
   uint32_t orgEnd = m_buffer.GetCurrentEndOffset ();
   bool resized = m_buffer.AddAtEnd (size);
   if (resized)
@@ -344,17 +655,63 @@ void
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  m_buffer.RemoveAtEnd (size);
+  uint32_t left = size;
+  while (left > 0 && !m_segments.empty ())
+    {
+      Buffer &last = m_segments.back ();
+      uint32_t removed = std::min (left, last.GetSize ());
+      last.RemoveAtEnd (removed);
+      m_segmentsSize -= removed;
+      left -= removed;
+      if (last.GetSize () == 0)
+        {
+          m_segments.pop_back ();
+        }
+    }
+  m_buffer.RemoveAtEnd (left);
   m_metadata.RemoveAtEnd (size);
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  m_buffer.RemoveAtStart (size);
+  uint32_t left = size;
+  while (left >= m_buffer.GetSize () && !m_segments.empty ())
+    {
+      left -= m_buffer.GetSize ();
+      m_buffer.RemoveAtStart (m_buffer.GetSize ());
+      PopSegment ();
+    }
+  m_buffer.RemoveAtStart (left);
   m_metadata.RemoveAtStart (size);
 }
 
+void
+Packet::PopSegment (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_buffer.GetSize () == 0 && !m_segments.empty ());
+  int32_t end = m_buffer.GetCurrentEndOffset ();
+  m_buffer = m_segments.front ();
+  m_segments.erase (m_segments.begin ());
+  m_segmentsSize -= m_buffer.GetSize ();
+  // the byte tags of the segment move to the coordinates of its buffer
+  int32_t start = m_buffer.GetCurrentStartOffset ();
+  m_byteTagList.AddAtStart (start - end, start);
+}
+
+void
+Packet::DoGather (void)
+{
+  NS_LOG_FUNCTION (this << m_segments.size ());
+  int32_t orgStart = m_buffer.GetCurrentStartOffset ();
+  m_buffer.AddAtEnd (m_segments);
+  m_segments.clear ();
+  m_segmentsSize = 0;
+  int32_t start = m_buffer.GetCurrentStartOffset ();
+  m_byteTagList.AddAtStart (start - orgStart, start);
+}
+
 void 
 Packet::RemoveAllByteTags (void)
 {
@@ -366,6 +723,7 @@ uint8_t const *
 Packet::PeekData (void) const
 {
   NS_LOG_FUNCTION (this);
+  Gather ();
   uint32_t oldStart = m_buffer.GetCurrentStartOffset ();
   uint8_t const * data = m_buffer.PeekData ();
   uint32_t newStart = m_buffer.GetCurrentStartOffset ();
@@ -378,12 +736,34 @@ Packet::PeekData (void) const
 uint32_t 
 Packet::CopyData (uint8_t *buffer, uint32_t size) const
 {
+  Gather ();
   return m_buffer.CopyData (buffer, size);
 }
 
+uint8_t const *
+Packet::PeekBytes (uint32_t offset, uint32_t size, uint8_t *copy) const
+{
+  NS_LOG_FUNCTION (this << offset << size);
+  Gather ();
+  if (offset + size > m_buffer.GetSize ())
+    {
+      return 0;
+    }
+  uint8_t const *data = m_buffer.PeekBytes (offset, size);
+  if (data != 0)
+    {
+      return data;
+    }
+  Buffer::Iterator i = m_buffer.Begin ();
+  i.Next (offset);
+  i.Read (copy, size);
+  return copy;
+}
+
 void
 Packet::CopyData (std::ostream *os, uint32_t size) const
 {
+  Gather ();
   return m_buffer.CopyData (os, size);
 }
 
@@ -426,6 +806,13 @@ Packet::PrintByteTags (std::ostream &os) const
 void 
 Packet::Print (std::ostream &os) const
 {
+  if (!m_metadata.IsRecording ())
+    {
+      NS_LOG_WARN ("packet " << GetUid () << " has no metadata to print: it was created before "
+                   "Packet::EnablePrinting, outside of the selected nodes, or its metadata "
+                   "exceeded the size limit");
+    }
+  Gather ();
   PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
   while (i.HasNext ())
     {
@@ -543,6 +930,7 @@ Packet::Print (std::ostream &os) const
 PacketMetadata::ItemIterator 
 Packet::BeginItem (void) const
 {
+  Gather ();
   return m_metadata.BeginItem (m_buffer);
 }
 
@@ -553,6 +941,27 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnablePrinting (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (nodeId);
+  PacketMetadata::EnableContext (nodeId);
+}
+
+void
+Packet::SetMetadataSizeLimit (uint32_t size)
+{
+  NS_LOG_FUNCTION (size);
+  PacketMetadata::SetSizeLimit (size);
+}
+
+void
+Packet::EnableMetadata (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_metadata.EnableRecording (GetSize ());
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -562,6 +971,8 @@ Packet::EnableChecking (void)
 
 uint32_t Packet::GetSerializedSize (void) const
 {
+  // the size of the serialized buffer depends on its zero area
+  Gather ();
   uint32_t size = 0;
 
   if (m_nixVector)
@@ -605,6 +1016,7 @@ uint32_t Packet::GetSerializedSize (void) const
 uint32_t 
 Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
+  Gather ();
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -809,19 +1221,23 @@ Packet::AddByteTag (const Tag &tag) const
   ByteTagList *list = const_cast<ByteTagList *> (&m_byteTagList);
   TagBuffer buffer = list->Add (tag.GetInstanceTypeId (), tag.GetSerializedSize (), 
                                 m_buffer.GetCurrentStartOffset (),
-                                m_buffer.GetCurrentEndOffset ());
+                                GetEndOffset ());
   tag.Serialize (buffer);
 }
 ByteTagIterator 
 Packet::GetByteTagIterator (void) const
 {
-  return ByteTagIterator (m_byteTagList.Begin (m_buffer.GetCurrentStartOffset (), m_buffer.GetCurrentEndOffset ()));
+  return ByteTagIterator (m_byteTagList.Begin (m_buffer.GetCurrentStartOffset (), GetEndOffset ()));
 }
 
 bool 
 Packet::FindFirstMatchingByteTag (Tag &tag) const
 {
   TypeId tid = tag.GetInstanceTypeId ();
+  if (!m_byteTagList.MayContain (tid))
+    {
+      return false;
+    }
   ByteTagIterator i = GetByteTagIterator ();
   while (i.HasNext ())
     {
@@ -835,6 +1251,26 @@ Packet::FindFirstMatchingByteTag (Tag &tag) const
   return false;
 }
 
+bool
+Packet::RemoveByteTag (Tag &tag)
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName ());
+  bool found = FindFirstMatchingByteTag (tag);
+  m_byteTagList.Remove (tag.GetInstanceTypeId ());
+  return found;
+}
+
+void
+Packet::ReplaceByteTag (const Tag &tag) const
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize ());
+  ByteTagList *list = const_cast<ByteTagList *> (&m_byteTagList);
+  TagBuffer buffer = list->Replace (tag.GetInstanceTypeId (), tag.GetSerializedSize (), 
+                                    m_buffer.GetCurrentStartOffset (),
+                                    GetEndOffset ());
+  tag.Serialize (buffer);
+}
+
 void 
 Packet::AddPacketTag (const Tag &tag) const
 {
@@ -887,7 +1323,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Begin (), m_packetTagList.End ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
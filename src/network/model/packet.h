@@ -21,6 +21,8 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <vector>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -147,8 +149,10 @@ private:
   Item Next (void);
 private:
   friend class Packet;
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *begin,
+                     const struct PacketTagList::TagData *end);
   const struct PacketTagList::TagData *m_current;
+  const struct PacketTagList::TagData *m_end;
 };
 
 /**
@@ -210,6 +214,7 @@ public:
    */
   Packet ();
   Packet (const Packet &o);
+  ~Packet ();
   Packet &operator = (const Packet &o);
   /**
    * Create a packet with a zero-filled payload.
@@ -273,6 +278,21 @@ public:
    * \returns the number of bytes removed from the packet.
    */
   uint32_t RemoveHeader (Header &header);
+  /**
+   * Deserialize and remove a header of known size from the internal
+   * buffer. This method invokes Header::Deserialize.
+   *
+   * Unlike RemoveHeader (Header &), this method does not gather the
+   * packets concatenated by AddAtEnd when the first buffer of the packet
+   * holds the size bytes of the header: Header::Deserialize is then given
+   * an iterator which ends with this buffer, so the header must not read
+   * past its own bytes, for example to compute a checksum.
+   *
+   * \param header a reference to the header to remove from the internal buffer.
+   * \param size the number of bytes of the header.
+   * \returns the number of bytes removed from the packet.
+   */
+  uint32_t RemoveHeader (Header &header, uint32_t size);
   /**
    * Deserialize but does _not_ remove the header from the internal buffer.
    * This method invokes Header::Deserialize.
@@ -281,6 +301,19 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header) const;
+  /**
+   * Deserialize but does _not_ remove a header of known size from the
+   * internal buffer. This method invokes Header::Deserialize.
+   *
+   * As RemoveHeader (Header &, uint32_t), this method reads the header
+   * in place, without gathering the packet, when the first buffer of the
+   * packet holds its size bytes.
+   *
+   * \param header a reference to the header to read from the internal buffer.
+   * \param size the number of bytes of the header.
+   * \returns the number of bytes read from the packet.
+   */
+  uint32_t PeekHeader (Header &header, uint32_t size) const;
   /**
    * Add trailer to this packet. This method invokes the
    * Trailer::GetSerializedSize and Trailer::Serialize
@@ -311,6 +344,12 @@ public:
    * Concatenate the input packet at the end of the current
    * packet. This does not alter the uid of either packet.
    *
+   * The bytes of packets which are not small are not copied: this
+   * packet references the buffer of the input packet, and the bytes
+   * are gathered in a single buffer only when they are accessed, for
+   * example to add or remove a header or to serialize the packet.
+   * Fragments of such a packet reference the same buffers.
+   *
    * \param packet packet to concatenate
    */
   void AddAtEnd (Ptr<const Packet> packet);
@@ -357,6 +396,20 @@ public:
    */
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * \param offset offset of the first byte from the start of the packet
+   * \param size number of bytes
+   * \param copy a byte buffer of at least \b size bytes
+   * \returns a pointer to the requested bytes, or 0 if the packet holds
+   *          fewer than offset + size bytes.
+   *
+   * When the requested bytes are stored contiguously in the packet, the
+   * returned pointer points directly to them and is invalidated by any
+   * change to the packet. Otherwise, they are copied into \b copy and
+   * \b copy is returned.
+   */
+  uint8_t const *PeekBytes (uint32_t offset, uint32_t size, uint8_t *copy) const;
+
   /**
    * \param os pointer to output stream in which we want
    *        to write the packet data.
@@ -418,9 +471,30 @@ public:
    * perform the operations requested by the Print methods. If you
    * want to be able the Packet::Print method, 
    * you need to invoke this method at least once during the 
-   * simulation setup and before any packet is created.
+   * simulation setup. Packets created before the call do not
+   * record their metadata.
    */
   static void EnablePrinting (void);
+  /**
+   * \param nodeId the node whose packets should record their metadata
+   *
+   * Only record the metadata of the packets created in the context
+   * of the specified node, that is, of the flows it originates.
+   * This can be called for several nodes and is much cheaper than
+   * enabling printing for all packets.
+   */
+  static void EnablePrinting (uint32_t nodeId);
+  /**
+   * \param size the largest number of bytes of metadata a packet
+   *        may record before it drops its metadata altogether.
+   */
+  static void SetMetadataSizeLimit (uint32_t size);
+  /**
+   * Start recording the metadata of this packet, even if printing
+   * was not enabled for it. The existing content of the packet is
+   * recorded as a single payload item.
+   */
+  void EnableMetadata (void);
   /**
    * The packet metadata is also used to perform extensive
    * sanity checks at runtime when performing operations on a 
@@ -431,6 +505,29 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * Packets and their buffers are recycled through free lists kept
+   * by each thread rather than returned to the system allocator.
+   */
+  struct PoolStatistics
+  {
+    /// packets taken from the free list
+    uint64_t packetHits;
+    /// packets allocated by the system allocator
+    uint64_t packetMisses;
+    /// buffers taken from the free list
+    uint64_t bufferHits;
+    /// buffers allocated by the system allocator
+    uint64_t bufferMisses;
+  };
+  /**
+   * \return the free list statistics of the calling thread
+   */
+  static PoolStatistics GetPoolStatistics (void);
+
+  static void *operator new (size_t size);
+  static void operator delete (void *p, size_t size);
+
   /**
    * For packet serializtion, the total size is checked 
    * in order to determine the size of the buffer 
@@ -481,6 +578,26 @@ public:
    * provided tag instance.
    */
   bool FindFirstMatchingByteTag (Tag &tag) const;
+  /**
+   * \param tag the tag to remove from this packet
+   * \returns true if the requested tag type was found, false otherwise.
+   *
+   * Remove all the byte tags of the same type as the input tag. The
+   * first one found is copied in the user's provided tag instance.
+   */
+  bool RemoveByteTag (Tag &tag);
+  /**
+   * \param tag the new tag
+   *
+   * Remove all the byte tags of the same type as the input tag and tag
+   * every byte of this packet with it. If this packet held a single tag
+   * of this type with the same serialized size, it is overwritten in place.
+   * Tags which are updated at every hop should be stored with this method
+   * rather than with AddByteTag so that the list of tags does not grow
+   * with the length of the path. This method is const for the same reason
+   * as AddByteTag.
+   */
+  void ReplaceByteTag (const Tag &tag) const;
 
   /**
    * Remove all the tags stored in this packet.
@@ -558,6 +675,27 @@ private:
           const PacketTagList &packetTagList, const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
+  /**
+   * Copy the segments at the end of m_buffer, before the bytes of the
+   * packet are accessed.
+   *
+   * The const methods which read the bytes of the packet, such as
+   * PeekHeader, CopyData, PeekData or Print, call this method and so
+   * modify the packet: like its reference count, a packet which is
+   * shared between threads is not protected against this.
+   */
+  inline void Gather (void) const;
+  void DoGather (void);
+  /**
+   * Make the first segment the buffer of the packet, once the bytes of
+   * m_buffer have all been removed.
+   */
+  void PopSegment (void);
+  /**
+   * \returns the offset of the end of the packet, in the coordinates of
+   *          m_buffer which the byte tags use.
+   */
+  inline int32_t GetEndOffset (void) const;
 
   Buffer m_buffer;
   ByteTagList m_byteTagList;
@@ -567,6 +705,12 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector;
 
+  /* The buffers which follow m_buffer and have not been copied into it
+   * yet.  The byte tags see them as if they extended m_buffer.
+   */
+  std::vector<Buffer> m_segments;
+  uint32_t m_segmentsSize;
+
   static uint32_t m_globalUid;
 };
 
@@ -588,8 +732,10 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  * Dirty operations:
  *   - ns3::Packet::AddHeader
  *   - ns3::Packet::AddTrailer
- *   - both versions of ns3::Packet::AddAtEnd
+ *   - ns3::Packet::AddAtEnd with a small packet
  *   - ns3::Packet::RemovePacketTag
+ *   - ns3::Packet::RemoveByteTag
+ *   - ns3::Packet::ReplaceByteTag (unless the tag can be overwritten in place)
  *
  * Non-dirty operations:
  *   - ns3::Packet::AddPacketTag
@@ -601,6 +747,7 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::RemoveHeader
  *   - ns3::Packet::RemoveTrailer
  *   - ns3::Packet::CreateFragment
+ *   - ns3::Packet::AddAtEnd with a larger packet
  *   - ns3::Packet::RemoveAtStart
  *   - ns3::Packet::RemoveAtEnd
  *   - ns3::Packet::CopyData
@@ -610,6 +757,14 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  * dirty operations have been optimized for common use-cases which
  * means that most of the time, these operations will not trigger
  * data copies and will thus be still very fast.
+ *
+ * The packets concatenated by AddAtEnd are copied once, by the first
+ * operation which accesses the bytes of the packet rather than its
+ * size: adding or removing a header or a trailer, CopyData, PeekData
+ * or Serialize. This includes the const methods, so that a packet
+ * shared between threads must not be concatenated. A header of known
+ * size which lies in the first buffer can be read without this copy,
+ * with PeekHeader (Header &, uint32_t) and RemoveHeader (Header &, uint32_t).
  */
 
 } // namespace ns3
@@ -619,7 +774,22 @@ namespace ns3 {
 uint32_t 
 Packet::GetSize (void) const
 {
-  return m_buffer.GetSize ();
+  return m_buffer.GetSize () + m_segmentsSize;
+}
+
+int32_t
+Packet::GetEndOffset (void) const
+{
+  return m_buffer.GetCurrentEndOffset () + m_segmentsSize;
+}
+
+void
+Packet::Gather (void) const
+{
+  if (!m_segments.empty ())
+    {
+      const_cast<Packet *> (this)->DoGather ();
+    }
 }
 
 } // namespace ns3
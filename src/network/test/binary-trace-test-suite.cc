@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/binary-trace.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+/**
+ * Write a few events through the default sinks of AsciiTraceHelper
+ * and check that they are decoded as they were written.
+ */
+class BinaryTraceTestCase : public TestCase
+{
+public:
+  BinaryTraceTestCase (bool compress);
+
+private:
+  virtual void DoRun (void);
+  bool m_compress;
+};
+
+BinaryTraceTestCase::BinaryTraceTestCase (bool compress)
+  : TestCase (compress ? "Check that compressed binary traces are decoded" : "Check that binary traces are decoded"),
+    m_compress (compress)
+{
+}
+
+void
+BinaryTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("trace.bin");
+  Ptr<OutputStreamWrapper> stream = AsciiTraceHelper ().CreateBinaryFileStream (filename, m_compress);
+  NS_TEST_ASSERT_MSG_NE (stream->GetBinaryWriter (), 0, "The stream should have a binary writer");
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddByteTag (FlowIdTag (7));
+  Ptr<Packet> q = Create<Packet> (40);
+  std::string context = "/NodeList/2/DeviceList/1/$ns3::PointToPointNetDevice/TxQueue/Enqueue";
+  Simulator::ScheduleWithContext (2, Seconds (1.5), &AsciiTraceHelper::DefaultEnqueueSinkWithContext,
+                                  stream, context, p);
+  Simulator::ScheduleWithContext (3, Seconds (2.25), &AsciiTraceHelper::DefaultReceiveSinkWithoutContext,
+                                  stream, q);
+  // a second event of the same context
+  Simulator::ScheduleWithContext (2, Seconds (3), &AsciiTraceHelper::DefaultDropSinkWithContext,
+                                  stream, context, q);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  // close the file
+  stream = 0;
+
+  std::ostringstream columns;
+  BinaryTraceDecode (filename, columns, false);
+  std::ostringstream expected;
+  expected << "+ 1.5 2 1 " << p->GetUid () << " 100 7" << std::endl
+           << "r 2.25 3 -1 " << q->GetUid () << " 40 0" << std::endl
+           << "d 3 2 1 " << q->GetUid () << " 40 0" << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (columns.str (), expected.str (), "Wrong events decoded");
+
+  std::ostringstream ascii;
+  BinaryTraceDecode (filename, ascii, true);
+  expected.str ("");
+  expected << "+ 1.5 " << context << " " << std::endl
+           << "r 2.25 " << std::endl
+           << "d 3 " << context << " " << std::endl;
+  NS_TEST_EXPECT_MSG_EQ (ascii.str (), expected.str (), "Wrong ascii trace decoded");
+}
+
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceTestCase (false));
+  AddTestCase (new BinaryTraceTestCase (true));
+}
+
+static BinaryTraceTestSuite binaryTraceTestSuite;
@@ -1,6 +1,8 @@
 #include "ns3/buffer.h"
 #include "ns3/random-variable.h"
 #include "ns3/test.h"
+#include <vector>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -299,6 +301,31 @@ BufferTest::DoRun (void)
   i.Write (buffer.Begin (), buffer.End ());
   ENSURE_WRITTEN_BYTES (other, 9, 0x1, 0x2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3, 0x4);
 
+  // zero-filled payloads stay virtual through fragmentation, concatenation
+  // and header addition
+  Buffer payload (1000);
+  Buffer head = payload.CreateFragment (0, 600);
+  Buffer tail = payload.CreateFragment (600, 400);
+  head.AddAtEnd (tail);
+  head.AddAtEnd (payload);
+  head.AddAtStart (2);
+  i = head.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  Buffer trailer;
+  trailer.AddAtStart (1);
+  trailer.Begin ().WriteU8 (0x3);
+  head.AddAtEnd (trailer);
+  NS_TEST_ASSERT_MSG_EQ (head.GetSize (), 2003, "Wrong size after concatenation");
+  NS_TEST_EXPECT_MSG_LT (head.GetSerializedSize (), 32, "Zero-filled payload was materialized");
+  NS_TEST_EXPECT_MSG_EQ (tail.GetSize (), 400, "Fragment modified by concatenation");
+  std::vector<uint8_t> bytes (head.GetSize ());
+  head.CopyData (&bytes[0], bytes.size ());
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[0], 0x1, "Header lost");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[1], 0x2, "Header lost");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[2002], 0x3, "Trailer lost");
+  NS_TEST_EXPECT_MSG_EQ (std::count (bytes.begin (), bytes.end (), 0), 2000, "Payload should be zero");
+
   // BUG #1001
   std::string ct ("This is the next content of the buffer.");
   buffer = Buffer ();
@@ -820,6 +820,25 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // packets whose metadata grows beyond the limit stop recording it
+  Packet::SetMetadataSizeLimit (20);
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  CHECK_HISTORY (p, 2, 1, 10);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  CHECK_HISTORY (p, 0);
+  ADD_HEADER (p, 5);
+  CHECK_HISTORY (p, 0);
+  p1 = Create<Packet> (5);
+  p1->AddAtEnd (p);
+  CHECK_HISTORY (p1, 0);
+  Packet::SetMetadataSizeLimit (0xffff);
+  p->EnableMetadata ();
+  ADD_HEADER (p, 6);
+  CHECK_HISTORY (p, 2, 6, 25);
 }
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
@@ -19,8 +19,11 @@
  */
 #include "ns3/packet.h"
 #include "ns3/test.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/simulator.h"
 #include <string>
 #include <stdarg.h>
+#include <string.h>
 
 namespace ns3 {
 
@@ -82,8 +85,9 @@ public:
 class ATestHeaderBase : public Header
 {
 public:
-  ATestHeaderBase () : Header (), m_error (false) {}
+  ATestHeaderBase () : Header (), m_error (false), m_available (0) {}
   bool m_error;
+  uint32_t m_available;
 };
 
 template <int N>
@@ -113,6 +117,7 @@ public:
       }
   }
   virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_available = iter.GetSize ();
     for (uint32_t i = 0; i < N; ++i)
       {
         uint8_t v = iter.ReadU8 ();
@@ -420,6 +425,36 @@ PacketTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (b), false, "trivial");
   }
 
+  {
+    // more packet tags than the list stores inline
+    Packet p;
+    p.AddPacketTag (ATestTag<1> ());
+    p.AddPacketTag (ATestTag<2> ());
+    p.AddPacketTag (ATestTag<3> ());
+    Packet copy = p;
+    p.AddPacketTag (ATestTag<4> ());
+    p.AddPacketTag (ATestTag<5> ());
+    Packet big = p;
+    ATestTag<2> b;
+    NS_TEST_EXPECT_MSG_EQ (p.RemovePacketTag (b), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (b.m_error, false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (b), false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (big.PeekPacketTag (b), true, "trivial");
+    ATestTag<5> e;
+    NS_TEST_EXPECT_MSG_EQ (p.RemovePacketTag (e), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (big.PeekPacketTag (e), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (copy.PeekPacketTag (e), false, "trivial");
+    std::ostringstream oss;
+    p.PrintPacketTags (oss);
+    NS_TEST_EXPECT_MSG_EQ (oss.str (), "1 3 4", "trivial");
+    oss.str ("");
+    big.PrintPacketTags (oss);
+    NS_TEST_EXPECT_MSG_EQ (oss.str (), "1 2 3 4 5", "trivial");
+    ATestTag<4> d;
+    NS_TEST_EXPECT_MSG_EQ (p.PeekPacketTag (d), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (d.m_error, false, "trivial");
+  }
+
   {
     // bug 572
     Ptr<Packet> tmp = Create<Packet> (1000);
@@ -434,6 +469,204 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (20, 1, 1001));
 #endif
   }
+
+  {
+    // contiguous bytes are not copied
+    uint8_t bytes[4] = { 1, 2, 3, 4 };
+    Ptr<Packet> tmp = Create<Packet> (bytes, 4);
+    tmp->AddAtEnd (Create<Packet> (10));
+    uint8_t copy[8];
+    uint8_t const *data = tmp->PeekBytes (1, 2, copy);
+    NS_TEST_EXPECT_MSG_NE (data, copy, "trivial");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[0], 2, "trivial");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[1], 3, "trivial");
+    data = tmp->PeekBytes (2, 8, copy);
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[0], 3, "trivial");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[1], 4, "trivial");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[7], 0, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekBytes (10, 5, copy), 0, "trivial");
+  }
+
+  {
+    // byte tags replaced at every hop
+    Ptr<Packet> tmp = Create<Packet> (1000);
+    tmp->AddByteTag (ATestTag<10> ());
+    Ptr<Packet> copy = tmp->Copy ();
+    for (uint32_t i = 0; i < 3; ++i)
+      {
+        tmp->AddHeader (ATestHeader<2> ());
+        tmp->ReplaceByteTag (ATestTag<20> ());
+      }
+    CHECK (tmp, 2, E (10, 6, 1006), E (20, 0, 1006));
+    CHECK (copy, 1, E (10, 0, 1000));
+    ATestTag<30> absent;
+    NS_TEST_EXPECT_MSG_EQ (tmp->FindFirstMatchingByteTag (absent), false, "trivial");
+    ATestTag<10> a;
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemoveByteTag (a), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (a.m_error, false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemoveByteTag (a), false, "trivial");
+    CHECK (tmp, 1, E (20, 0, 1006));
+    CHECK (copy, 1, E (10, 0, 1000));
+  }
+
+  {
+    // packets appended by AddAtEnd are only copied when their bytes are read
+    uint8_t bytes[300];
+    for (uint32_t i = 0; i < 300; ++i)
+      {
+        bytes[i] = i;
+      }
+    Ptr<Packet> a = Create<Packet> (bytes + 10, 150);
+    a->AddByteTag (ATestTag<1> ());
+    Ptr<Packet> b = Create<Packet> (bytes + 160, 140);
+    b->AddByteTag (ATestTag<2> ());
+    Ptr<Packet> tmp = Create<Packet> (bytes, 10);
+    tmp->AddAtEnd (a);
+    tmp->AddAtEnd (b);
+    tmp->AddAtEnd (Create<Packet> (500));
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 800, "trivial");
+    CHECK (tmp, 2, E (1, 10, 160), E (2, 160, 300));
+    Ptr<Packet> copy = tmp->Copy ();
+
+    Ptr<Packet> frag = tmp->CreateFragment (100, 150);
+    NS_TEST_EXPECT_MSG_EQ (frag->GetSize (), 150, "trivial");
+    CHECK (frag, 2, E (1, 0, 60), E (2, 60, 150));
+    uint8_t data[800];
+    frag->CopyData (data, 150);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (data, bytes + 100, 150), 0, "Fragment content mismatch");
+
+    frag = tmp->CreateFragment (160, 0);
+    NS_TEST_EXPECT_MSG_EQ (frag->GetSize (), 0, "trivial");
+    frag = tmp->CreateFragment (800, 0);
+    NS_TEST_EXPECT_MSG_EQ (frag->GetSize (), 0, "trivial");
+
+    tmp->RemoveAtStart (20);
+    tmp->RemoveAtEnd (400);
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 380, "trivial");
+    CHECK (tmp, 2, E (1, 0, 140), E (2, 140, 280));
+    tmp->AddHeader (ATestHeader<4> ());
+    CHECK (tmp, 2, E (1, 4, 144), E (2, 144, 284));
+    ATestHeader<4> header;
+    tmp->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "trivial");
+    tmp->CopyData (data, 380);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (data, bytes + 20, 280), 0, "Packet content mismatch");
+    uint32_t k = 280;
+    while (k < 380 && data[k] == 0)
+      {
+        k++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (k, 380, "The padding should be zero");
+    CHECK (tmp, 2, E (1, 0, 140), E (2, 140, 280));
+
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 800, "trivial");
+    CHECK (copy, 2, E (1, 10, 160), E (2, 160, 300));
+    copy->CopyData (data, 300);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (data, bytes, 300), 0, "Copy content mismatch");
+    a->CopyData (data, 150);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (data, bytes + 10, 150), 0, "Appended packet should be unchanged");
+  }
+
+  {
+    // a header of known size is read in the first buffer without gathering
+    Ptr<Packet> tmp = Create<Packet> (200);
+    tmp->AddHeader (ATestHeader<4> ());
+    tmp->AddAtEnd (Create<Packet> (300));
+    ATestHeader<4> header;
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekHeader (header, 4), 4, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (header.m_available, 204, "The header should be read in the first buffer");
+    NS_TEST_EXPECT_MSG_EQ (tmp->RemoveHeader (header, 4), 4, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (header.m_available, 204, "The header should be read in the first buffer");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 500, "trivial");
+    tmp->AddHeader (ATestHeader<4> ());
+    tmp->AddAtEnd (Create<Packet> (300));
+    tmp->PeekHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_available, 804, "A header of unknown size should see the whole packet");
+
+    // the header fills the first buffer
+    tmp = Create<Packet> ();
+    tmp->AddHeader (ATestHeader<4> ());
+    tmp->AddAtEnd (Create<Packet> (300));
+    tmp->RemoveHeader (header, 4);
+    NS_TEST_EXPECT_MSG_EQ (header.m_available, 4, "The header should be read in the first buffer");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 300, "trivial");
+    tmp->AddHeader (ATestHeader<4> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 304, "trivial");
+    tmp->RemoveHeader (header, 4);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (header.m_available, 304, "trivial");
+  }
+
+  {
+    MemoryAccounting::Enable ();
+    Ptr<Packet> tmp = Create<Packet> (1000);
+    Ptr<Packet> copy = tmp->Copy ();
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetUsage ("ns3::Packet").count, 2, "Live packets should be accounted");
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetUsage ("ns3::Buffer").count, 1, "Live buffers should be accounted");
+    tmp = 0;
+    copy = 0;
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetUsage ("ns3::Packet").count, 0, "Freed packets should not be accounted");
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetUsage ("ns3::Buffer").count, 0, "Recycled buffers should not be accounted");
+    // the buffer may come from the free list
+    tmp = Create<Packet> (1000);
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetUsage ("ns3::Buffer").count, 1, "Reused buffers should be accounted");
+    tmp = 0;
+    MemoryAccounting::Disable ();
+  }
+
+#ifdef BUFFER_FREE_LIST
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp = 0;
+    Packet::PoolStatistics before = Packet::GetPoolStatistics ();
+    tmp = Create<Packet> (100);
+    Packet::PoolStatistics after = Packet::GetPoolStatistics ();
+    NS_TEST_EXPECT_MSG_EQ (after.packetHits, before.packetHits + 1, "A freed packet should be reused");
+    NS_TEST_EXPECT_MSG_EQ (after.packetMisses, before.packetMisses, "A freed packet should be reused");
+  }
+#endif
+}
+//-----------------------------------------------------------------------------
+class PacketContextMetadataTest : public TestCase
+{
+public:
+  PacketContextMetadataTest ();
+  virtual void DoRun (void);
+private:
+  void CreatePacket (uint32_t i);
+  Ptr<Packet> m_packets[2];
+};
+
+PacketContextMetadataTest::PacketContextMetadataTest ()
+  : TestCase ("Check that printing can be enabled for the packets of a node")
+{
+}
+
+void
+PacketContextMetadataTest::CreatePacket (uint32_t i)
+{
+  m_packets[i] = Create<Packet> (10);
+  m_packets[i]->AddHeader (ATestHeader<4> ());
+}
+
+void
+PacketContextMetadataTest::DoRun (void)
+{
+  // no other test of this suite creates packets in this context
+  Packet::EnablePrinting (1000);
+  Simulator::ScheduleWithContext (1000, Seconds (1), &PacketContextMetadataTest::CreatePacket, this, 0);
+  Simulator::ScheduleWithContext (1001, Seconds (1), &PacketContextMetadataTest::CreatePacket, this, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  PacketMetadata::ItemIterator i = m_packets[0]->BeginItem ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "The packet of the selected node should have metadata");
+  NS_TEST_EXPECT_MSG_EQ (i.Next ().tid, ATestHeader<4>::GetTypeId (), "The header should be recorded");
+  i = m_packets[1]->BeginItem ();
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "The packet of another node should not have metadata");
+  m_packets[0] = 0;
+  m_packets[1] = 0;
 }
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
@@ -446,6 +679,7 @@ PacketTestSuite::PacketTestSuite ()
   : TestSuite ("packet", UNIT)
 {
   AddTestCase (new PacketTest);
+  AddTestCase (new PacketContextMetadataTest);
 }
 
 static PacketTestSuite g_packetTestSuite;
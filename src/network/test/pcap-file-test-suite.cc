@@ -20,10 +20,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sstream>
+#include <fstream>
 #include <cstring>
 
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcap-mapped-file.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -1101,6 +1107,138 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that PcapMappedFile reads the same records as
+// PcapFile from a known good pcap file.
+// ===========================================================================
+class MappedReadTestCase : public TestCase
+{
+public:
+  MappedReadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MappedReadTestCase::MappedReadTestCase ()
+  : TestCase ("Check that PcapMappedFile reads the records of a known good pcap file")
+{
+}
+
+void
+MappedReadTestCase::DoRun (void)
+{
+  std::string filename = CreateDataDirFilename ("known.pcap");
+  PcapMappedFile mapped;
+  mapped.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (mapped.Fail (), false, "Could not map " << filename);
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetDataLinkType (), 1, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (mapped.GetSnapLen (), 65535, "Wrong snaplen");
+
+  for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+      PcapMappedFile::Record record;
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          PacketEntry const & p = knownPackets[i];
+          NS_TEST_ASSERT_MSG_EQ (mapped.Next (record), true, "Record " << i << " is missing");
+          NS_TEST_EXPECT_MSG_EQ (record.tsSec, p.tsSec, "Wrong seconds in record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.tsUsec, p.tsUsec, "Wrong microseconds in record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.inclLen, p.inclLen, "Wrong included length in record " << i);
+          NS_TEST_EXPECT_MSG_EQ (record.origLen, p.origLen, "Wrong original length in record " << i);
+          for (uint32_t j = 0; j < N_PACKET_BYTES; ++j)
+            {
+              uint16_t v = (record.data[14 + 2 * j] << 8) | record.data[15 + 2 * j];
+              NS_TEST_EXPECT_MSG_EQ (v, p.data[j], "Wrong data in record " << i);
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (mapped.Next (record), false, "There should be no extra record");
+      NS_TEST_EXPECT_MSG_EQ (mapped.Fail (), false, "The file is not truncated");
+      mapped.Rewind ();
+    }
+
+  mapped.Open (CreateTempDirFilename ("missing.pcap"));
+  NS_TEST_EXPECT_MSG_EQ (mapped.Fail (), true, "A missing file cannot be read");
+
+  // a record whose length is corrupted
+  filename = CreateTempDirFilename ("corrupted.pcap");
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  f.Init (1, 65535);
+  f.Close ();
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary | std::ios::app);
+  uint32_t header[4] = { 1, 0, 0xfffffff0, 0xfffffff0 };
+  os.write ((const char *)header, sizeof (header));
+  os.write ((const char *)header, sizeof (header));
+  os.close ();
+  mapped.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (mapped.Fail (), false, "Could not map " << filename);
+  PcapMappedFile::Record record;
+  NS_TEST_EXPECT_MSG_EQ (mapped.Next (record), false, "A corrupted record cannot be read");
+  NS_TEST_EXPECT_MSG_EQ (mapped.Fail (), true, "A corrupted record should stop the reading");
+  NS_TEST_EXPECT_MSG_EQ (mapped.Next (record), false, "A corrupted record cannot be skipped");
+  mapped.Close ();
+}
+
+// ===========================================================================
+// Test case to make sure that the packets written by an asynchronous and
+// buffered PcapFileWrapper are all in the file, truncated to the snaplen.
+// ===========================================================================
+class AsynchronousWriteTestCase : public TestCase
+{
+public:
+  AsynchronousWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsynchronousWriteTestCase::AsynchronousWriteTestCase ()
+  : TestCase ("Check that asynchronous writes end up in the file")
+{
+}
+
+void
+AsynchronousWriteTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("async.pcap");
+  Ptr<PcapFileWrapper> wrapper = CreateObject<PcapFileWrapper> ();
+  wrapper->SetAttribute ("Asynchronous", BooleanValue (true));
+  wrapper->SetAttribute ("BufferSize", UintegerValue (1 << 20));
+  wrapper->Open (filename, std::ios::out);
+  wrapper->Init (1, 100);
+  NS_TEST_ASSERT_MSG_EQ (wrapper->Fail (), false, "Could not open " << filename);
+
+  uint8_t bytes[300];
+  // enough packets to wrap around the ring of the writer
+  uint32_t n = 50000;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      memset (bytes, i & 0xff, sizeof (bytes));
+      uint32_t size = (i % 3 == 0) ? 50 : 300;
+      Ptr<Packet> p = Create<Packet> (bytes, size);
+      wrapper->Write (MicroSeconds (i), p);
+    }
+  NS_TEST_EXPECT_MSG_EQ (wrapper->Fail (), false, "Writes must not fail");
+  wrapper->Close ();
+
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Could not open " << filename);
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      f.Read (bytes, sizeof (bytes), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Packet " << i << " is missing");
+      NS_TEST_ASSERT_MSG_EQ (tsUsec, i % 1000000, "Packets are out of order");
+      NS_TEST_ASSERT_MSG_EQ (origLen, ((i % 3 == 0) ? 50 : 300), "Wrong original length");
+      NS_TEST_ASSERT_MSG_EQ (inclLen, ((i % 3 == 0) ? 50 : 100), "Packets should be truncated to the snaplen");
+      NS_TEST_ASSERT_MSG_EQ (bytes[inclLen - 1], (i & 0xff), "Wrong packet data");
+    }
+  f.Read (bytes, sizeof (bytes), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "There should be no extra packet");
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1118,6 +1256,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase);
   AddTestCase (new ReadFileTestCase);
   AddTestCase (new DiffTestCase);
+  AddTestCase (new AsynchronousWriteTestCase);
+  AddTestCase (new MappedReadTestCase);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
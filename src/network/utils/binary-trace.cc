@@ -0,0 +1,391 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace.h"
+#include "flow-id-tag.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/checkpoint.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/*
+ * File layout, in host byte order:
+ *   header: "NS3BTRC1", int64_t femtoseconds per time step
+ *   context record: 'C', or 'I' if the interface is printed after the
+ *     context, uint32_t id, uint32_t length, context
+ *   event record: type, uint32_t context id (0xffffffff if none),
+ *     uint32_t node, uint32_t device, int64_t time step, uint64_t uid,
+ *     uint32_t size, uint32_t flow id (0 if none)
+ */
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTrace");
+
+namespace ns3 {
+
+namespace {
+
+const char g_magic[8] = { 'N', 'S', '3', 'B', 'T', 'R', 'C', '1' };
+const uint32_t NO_CONTEXT = 0xffffffff;
+
+/**
+ * \return the number following prefix in context, or def if context
+ *         does not contain prefix.
+ */
+uint32_t
+ParseIndex (std::string const &context, const char *prefix, uint32_t def)
+{
+  std::string::size_type pos = context.find (prefix);
+  if (pos == std::string::npos)
+    {
+      return def;
+    }
+  return strtoul (context.c_str () + pos + strlen (prefix), 0, 10);
+}
+
+/**
+ * Read a file written by BinaryTraceWriter, through zlib if it is
+ * available since it reads uncompressed files too.
+ */
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader (std::string filename);
+  ~BinaryTraceReader ();
+  bool Read (void *buffer, uint32_t size);
+  template <typename T>
+  bool Read (T &value)
+  {
+    return Read (&value, sizeof (value));
+  }
+private:
+#ifdef HAVE_ZLIB
+  gzFile m_file;
+#else
+  std::ifstream m_file;
+#endif
+};
+
+BinaryTraceReader::BinaryTraceReader (std::string filename)
+{
+#ifdef HAVE_ZLIB
+  m_file = gzopen (filename.c_str (), "rb");
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Could not open binary trace file " << filename);
+    }
+#else
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!m_file.good ())
+    {
+      NS_FATAL_ERROR ("Could not open binary trace file " << filename);
+    }
+#endif
+}
+
+BinaryTraceReader::~BinaryTraceReader ()
+{
+#ifdef HAVE_ZLIB
+  gzclose (m_file);
+#else
+  m_file.close ();
+#endif
+}
+
+bool
+BinaryTraceReader::Read (void *buffer, uint32_t size)
+{
+#ifdef HAVE_ZLIB
+  return gzread (m_file, buffer, size) == (int)size;
+#else
+  m_file.read ((char *)buffer, size);
+  return m_file.good ();
+#endif
+}
+
+} // anonymous namespace
+
+BinaryTraceWriter::BinaryTraceWriter (std::string filename, bool compress)
+#ifdef HAVE_ZLIB
+  : m_gzFile (0)
+#endif
+{
+  NS_LOG_FUNCTION (this << filename << compress);
+  m_buffer.reserve (BUFFER_SIZE);
+#ifdef HAVE_ZLIB
+  if (compress)
+    {
+      m_gzFile = gzopen (filename.c_str (), "wb");
+      if (m_gzFile == 0)
+        {
+          NS_FATAL_ERROR ("Could not open binary trace file " << filename);
+        }
+    }
+#else
+  if (compress)
+    {
+      NS_LOG_WARN ("zlib is not available, " << filename << " is not compressed");
+    }
+#endif
+#ifdef HAVE_ZLIB
+  if (m_gzFile == 0)
+#endif
+    {
+      m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!m_file.good ())
+        {
+          NS_FATAL_ERROR ("Could not open binary trace file " << filename);
+        }
+    }
+  m_buffer.insert (m_buffer.end (), g_magic, g_magic + sizeof (g_magic));
+  Append (TimeStep (1).GetFemtoSeconds ());
+  Checkpoint::RegisterOutput (this, filename);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  WriteBuffer ();
+  Checkpoint::UnregisterOutput (this);
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzclose ((gzFile)m_gzFile);
+      return;
+    }
+#endif
+  m_file.close ();
+}
+
+template <typename T>
+void
+BinaryTraceWriter::Append (T value)
+{
+  const char *p = (const char *)&value;
+  m_buffer.insert (m_buffer.end (), p, p + sizeof (T));
+}
+
+const BinaryTraceWriter::Context &
+BinaryTraceWriter::LookupContext (std::string const &context, bool printInterface)
+{
+  std::pair<std::string, bool> key = std::make_pair (context, printInterface);
+  std::map<std::pair<std::string, bool>, Context>::iterator i = m_contexts.find (key);
+  if (i != m_contexts.end ())
+    {
+      return i->second;
+    }
+  // the node and device are parsed once per context
+  Context c;
+  c.id = m_contexts.size ();
+  c.node = ParseIndex (context, "/NodeList/", 0xffffffff);
+  c.device = ParseIndex (context, "/DeviceList/", NO_DEVICE);
+  m_buffer.push_back (printInterface ? 'I' : 'C');
+  Append (c.id);
+  Append ((uint32_t)context.size ());
+  m_buffer.insert (m_buffer.end (), context.begin (), context.end ());
+  return m_contexts.insert (std::make_pair (key, c)).first->second;
+}
+
+void
+BinaryTraceWriter::Write (char type, std::string const &context, Ptr<const Packet> p)
+{
+  Write (type, context, NO_DEVICE, p, p->GetSize ());
+}
+
+void
+BinaryTraceWriter::Write (char type, std::string const &context, uint32_t device, Ptr<const Packet> p, uint32_t size,
+                          bool printInterface)
+{
+  NS_LOG_FUNCTION (this << type << context << device << p << size << printInterface);
+  uint32_t id = NO_CONTEXT;
+  uint32_t node = Simulator::GetContext ();
+  if (!context.empty ())
+    {
+      const Context &c = LookupContext (context, printInterface);
+      id = c.id;
+      if (c.node != 0xffffffff)
+        {
+          node = c.node;
+        }
+      if (device == NO_DEVICE)
+        {
+          device = c.device;
+        }
+    }
+  FlowIdTag tag;
+  uint32_t flowId = 0;
+  if (p->FindFirstMatchingByteTag (tag))
+    {
+      flowId = tag.GetFlowId ();
+    }
+  m_buffer.push_back (type);
+  Append (id);
+  Append (node);
+  Append (device);
+  Append (Simulator::Now ().GetTimeStep ());
+  Append (p->GetUid ());
+  Append (size);
+  Append (flowId);
+  if (m_buffer.size () >= BUFFER_SIZE)
+    {
+      WriteBuffer ();
+    }
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteBuffer ();
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzflush ((gzFile)m_gzFile, Z_SYNC_FLUSH);
+      return;
+    }
+#endif
+  m_file.flush ();
+}
+
+void
+BinaryTraceWriter::WriteBuffer (void)
+{
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzwrite ((gzFile)m_gzFile, &m_buffer[0], m_buffer.size ());
+      m_buffer.clear ();
+      return;
+    }
+#endif
+  m_file.write (&m_buffer[0], m_buffer.size ());
+  m_buffer.clear ();
+}
+
+void
+BinaryTraceDecode (std::string filename, std::ostream &os, bool ascii)
+{
+  BinaryTraceReader reader (filename);
+  char magic[sizeof (g_magic)];
+  int64_t fsPerStep;
+  if (!reader.Read (magic, sizeof (magic)) || memcmp (magic, g_magic, sizeof (magic)) != 0
+      || !reader.Read (fsPerStep))
+    {
+      NS_FATAL_ERROR (filename << " is not a binary trace file");
+    }
+  // the times are printed as the simulation did if its resolution was the same
+  bool sameResolution = fsPerStep == TimeStep (1).GetFemtoSeconds ();
+  // the contexts, and whether the interface is printed after them
+  std::map<uint32_t, std::pair<std::string, bool> > contexts;
+  std::string buffer;
+  char type;
+  while (reader.Read (type))
+    {
+      if (type == 'C' || type == 'I')
+        {
+          uint32_t id;
+          uint32_t length;
+          reader.Read (id);
+          reader.Read (length);
+          buffer.resize (length);
+          if (length != 0 && !reader.Read (&buffer[0], length))
+            {
+              break;
+            }
+          contexts[id] = std::make_pair (buffer, type == 'I');
+          continue;
+        }
+      if (type != '+' && type != '-' && type != 'd' && type != 'r' && type != 't')
+        {
+          NS_FATAL_ERROR ("Corrupted binary trace file " << filename);
+        }
+      uint32_t id;
+      uint32_t node;
+      uint32_t device;
+      int64_t timeStep;
+      uint64_t uid;
+      uint32_t size;
+      uint32_t flowId;
+      reader.Read (id);
+      reader.Read (node);
+      reader.Read (device);
+      reader.Read (timeStep);
+      reader.Read (uid);
+      reader.Read (size);
+      if (!reader.Read (flowId))
+        {
+          NS_LOG_WARN ("Truncated binary trace file " << filename);
+          break;
+        }
+      double seconds;
+      if (sameResolution)
+        {
+          seconds = TimeStep (timeStep).GetSeconds ();
+        }
+      else
+        {
+          seconds = timeStep * (fsPerStep / 1e15);
+        }
+      if (ascii)
+        {
+          os << type << " " << seconds << " ";
+          if (id != NO_CONTEXT)
+            {
+              const std::pair<std::string, bool> &c = contexts[id];
+              os << c.first;
+              if (c.second)
+                {
+                  os << "(" << device << ")";
+                }
+              os << " ";
+            }
+          os << std::endl;
+          continue;
+        }
+      os << type << " " << seconds << " ";
+      if (node == 0xffffffff)
+        {
+          os << "-1 ";
+        }
+      else
+        {
+          os << node << " ";
+        }
+      if (device == BinaryTraceWriter::NO_DEVICE)
+        {
+          os << "-1 ";
+        }
+      else
+        {
+          os << device << " ";
+        }
+      os << uid << " " << size << " " << flowId << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/core-config.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief Write packet trace events as fixed-width binary records
+ *
+ * Each event records its type ('+', '-', 'd', 'r' or 't' as in the
+ * ascii traces), time, node, device, packet uid, size and flow id in a
+ * few tens of bytes, instead of the text rendering of the packet.  The
+ * trace contexts are written once and then referred to by an index.
+ * The file can be compressed with zlib as it is written.
+ *
+ * Use BinaryTraceDecode or the print-binary-trace program to read the
+ * file back, as columns or in the format of the ascii traces.
+ */
+class BinaryTraceWriter
+{
+public:
+  enum
+  {
+    /** The device of events whose context does not name one. */
+    NO_DEVICE = 0xffffffff
+  };
+
+  /**
+   * \param filename the name of the file to create
+   * \param compress compress the file with zlib.  Ignored, with a
+   *        warning, if ns-3 was built without zlib.
+   */
+  BinaryTraceWriter (std::string filename, bool compress);
+  ~BinaryTraceWriter ();
+
+  /**
+   * \param type the type of the event
+   * \param context the trace context, or an empty string
+   * \param p the packet
+   *
+   * The node and device are taken from the context if it has them,
+   * otherwise the node is the context of the current event.
+   */
+  void Write (char type, std::string const &context, Ptr<const Packet> p);
+  /**
+   * \param type the type of the event
+   * \param context the trace context, or an empty string
+   * \param device the device, or interface, of the event
+   * \param p the packet
+   * \param size the size to record, which may include headers which
+   *        have already been removed from p
+   * \param printInterface whether the ascii traces print the device
+   *        after the context, as "context(device)", like the sinks of
+   *        the Ipv4 and Ipv6 protocols do
+   */
+  void Write (char type, std::string const &context, uint32_t device, Ptr<const Packet> p, uint32_t size,
+              bool printInterface = false);
+  /**
+   * Write the records buffered so far to the file, and flush it.
+   */
+  void Flush (void);
+
+private:
+  enum
+  {
+    BUFFER_SIZE = 64 * 1024
+  };
+  struct Context
+  {
+    uint32_t id;
+    uint32_t node;
+    uint32_t device;
+  };
+  BinaryTraceWriter (const BinaryTraceWriter &o);
+  BinaryTraceWriter &operator = (const BinaryTraceWriter &o);
+
+  const Context &LookupContext (std::string const &context, bool printInterface);
+  template <typename T>
+  void Append (T value);
+  void WriteBuffer (void);
+
+  std::map<std::pair<std::string, bool>, Context> m_contexts;
+  std::vector<char> m_buffer;
+  std::ofstream m_file;
+#ifdef HAVE_ZLIB
+  // a gzFile, which is not declared here to avoid including zlib.h
+  void *m_gzFile;
+#endif
+};
+
+/**
+ * \param filename the name of a file written by BinaryTraceWriter,
+ *        compressed or not
+ * \param os where to print the events
+ * \param ascii print the events in the format of the ascii traces
+ *        instead of columns
+ *
+ * The ascii traces print the headers of each packet, which are not
+ * stored in the binary traces: the lines are those of an ascii trace
+ * written without Packet::EnablePrinting.
+ */
+void BinaryTraceDecode (std::string filename, std::ostream &os, bool ascii);
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
@@ -276,7 +276,7 @@ CoDelQueue::DoEnqueue (Ptr<Packet> p)
     }
 
   CoDelTimestampTag tag;
-  p->AddByteTag (tag);
+  p->ReplaceByteTag (tag);
   m_bytesInQueue += p->GetSize ();
   m_packets.push (p);
 
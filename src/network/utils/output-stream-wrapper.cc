@@ -17,9 +17,11 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "binary-trace.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "ns3/checkpoint.h"
 #include <fstream>
 
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
@@ -27,7 +29,8 @@ NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 namespace ns3 {
 
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
-  : m_destroyable (true)
+  : m_destroyable (true),
+    m_binary (0)
 {
   std::ofstream* os = new std::ofstream ();
   os->open (filename.c_str (), filemode);
@@ -35,20 +38,30 @@ OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmo
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (os->is_open (), "AsciiTraceHelper::CreateFileStream():  " <<
                        "Unable to Open " << filename << " for mode " << filemode);
+  Checkpoint::RegisterOutput (this, filename);
 }
 
 OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
-  : m_ostream (os), m_destroyable (false)
+  : m_ostream (os), m_destroyable (false), m_binary (0)
 {
   FatalImpl::RegisterStream (m_ostream);
   NS_ABORT_MSG_UNLESS (m_ostream->good (), "Output stream is not vaild for writing.");
 }
 
+OutputStreamWrapper::OutputStreamWrapper (BinaryTraceWriter *writer)
+  : m_ostream (new std::ostream (0)), m_destroyable (true), m_binary (writer)
+{
+  FatalImpl::RegisterStream (m_ostream);
+}
+
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   FatalImpl::UnregisterStream (m_ostream);
+  Checkpoint::UnregisterOutput (this);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
+  delete m_binary;
+  m_binary = 0;
 }
 
 std::ostream *
@@ -57,4 +70,10 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+BinaryTraceWriter *
+OutputStreamWrapper::GetBinaryWriter (void)
+{
+  return m_binary;
+}
+
 } // namespace ns3
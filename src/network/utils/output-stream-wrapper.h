@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class BinaryTraceWriter;
+
 /*
  * @brief A class encapsulating an STL output stream.
  *
@@ -72,6 +74,15 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
 public:
   OutputStreamWrapper (std::string filename, std::ios::openmode filemode);
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * \param writer a binary trace file, which the wrapper deletes when
+   *        it is destroyed
+   *
+   * The trace sinks of the helpers write binary records to the wrapper
+   * instead of text.  The stream of the wrapper discards what is written
+   * to it.
+   */
+  OutputStreamWrapper (BinaryTraceWriter *writer);
   ~OutputStreamWrapper ();
 
   /**
@@ -83,9 +94,16 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * \returns the binary trace file of the wrapper, or zero if it wraps
+   *          a text stream.
+   */
+  BinaryTraceWriter *GetBinaryWriter (void);
+
 private:
   std::ostream *m_ostream;
   bool m_destroyable;
+  BinaryTraceWriter *m_binary;
 };
 
 } // namespace ns3
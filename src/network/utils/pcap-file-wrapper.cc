@@ -18,14 +18,129 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/core-config.h"
 #include "pcap-file-wrapper.h"
 
+#include <algorithm>
+#include <string.h>
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/async-writer.h"
+#endif
+
 NS_LOG_COMPONENT_DEFINE ("PcapFileWrapper");
 
 namespace ns3 {
 
+#ifdef HAVE_PTHREAD_H
+namespace {
+
+/**
+ * Queue of the pcap records of all the files, which are written by the
+ * thread of an AsyncWriter.  Each record is a Record followed by its
+ * data.
+ */
+class PcapWriter
+{
+public:
+  struct Record
+  {
+    PcapFile *file;
+    uint32_t tsSec;
+    uint32_t tsUsec;
+    uint32_t inclLen;
+    uint32_t origLen;
+  };
+
+  PcapWriter ();
+  ~PcapWriter ();
+  /**
+   * \param record the record to queue
+   * \returns where the inclLen bytes of data of the record should be
+   *          copied before Commit is called.
+   */
+  uint8_t *Reserve (const Record &record);
+  void Commit (void);
+  /**
+   * Wait until all the records queued were written.
+   */
+  void Drain (void);
+
+private:
+  enum
+  {
+    RING_SIZE = 4 * 1024 * 1024
+  };
+  void Consume (const uint8_t *data, uint32_t size);
+
+  AsyncWriter m_writer;
+};
+
+PcapWriter::PcapWriter ()
+  : m_writer (RING_SIZE, MakeCallback (&PcapWriter::Consume, this))
+{
+}
+
+PcapWriter::~PcapWriter ()
+{
+}
+
+uint8_t *
+PcapWriter::Reserve (const Record &record)
+{
+  uint8_t *data = m_writer.Reserve (sizeof (Record) + record.inclLen);
+  memcpy (data, &record, sizeof (Record));
+  return data + sizeof (Record);
+}
+
+void
+PcapWriter::Commit (void)
+{
+  m_writer.Commit ();
+}
+
+void
+PcapWriter::Drain (void)
+{
+  m_writer.Drain ();
+}
+
+void
+PcapWriter::Consume (const uint8_t *data, uint32_t size)
+{
+  const Record *record = reinterpret_cast<const Record *> (data);
+  record->file->Write (record->tsSec, record->tsUsec, data + sizeof (Record),
+                       record->inclLen, record->origLen);
+}
+
+PcapWriter *g_pcapWriter = 0;
+
+PcapWriter *
+GetPcapWriter (void)
+{
+  if (g_pcapWriter == 0)
+    {
+      g_pcapWriter = new PcapWriter ();
+    }
+  return g_pcapWriter;
+}
+
+static class PcapWriterCloser
+{
+public:
+  ~PcapWriterCloser ()
+  {
+    delete g_pcapWriter;
+    g_pcapWriter = 0;
+  }
+} g_pcapWriterCloser;
+
+} // anonymous namespace
+#endif /* HAVE_PTHREAD_H */
+
 NS_OBJECT_ENSURE_REGISTERED (PcapFileWrapper);
 
 TypeId 
@@ -39,12 +154,25 @@ PcapFileWrapper::GetTypeId (void)
                    UintegerValue (PcapFile::SNAPLEN_DEFAULT),
                    MakeUintegerAccessor (&PcapFileWrapper::m_snapLen),
                    MakeUintegerChecker<uint32_t> (0, PcapFile::SNAPLEN_DEFAULT))
+    .AddAttribute ("BufferSize",
+                   "Size of the buffer used to write the file, "
+                   "zero for the default of the standard library",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Asynchronous",
+                   "Whether the packets are written to the file by a separate thread",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asynchronous),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_bufferSize (0),
+    m_asynchronous (false)
 {
 }
 
@@ -54,14 +182,73 @@ PcapFileWrapper::~PcapFileWrapper ()
 }
 
 
+bool
+PcapFileWrapper::IsAsynchronous (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  return m_asynchronous;
+#else
+  return false;
+#endif
+}
+
+void
+PcapFileWrapper::Drain (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_asynchronous && g_pcapWriter != 0)
+    {
+      g_pcapWriter->Drain ();
+    }
+#endif
+}
+
+void
+PcapFileWrapper::Queue (Time t, Header *header, Ptr<const Packet> p, uint8_t const *buffer, uint32_t length)
+{
+#ifdef HAVE_PTHREAD_H
+  uint64_t current = t.GetMicroSeconds ();
+  PcapWriter::Record record;
+  record.file = &m_file;
+  record.tsSec = current / 1000000;
+  record.tsUsec = current % 1000000;
+
+  uint32_t headerSize = (header != 0) ? header->GetSerializedSize () : 0;
+  record.origLen = (p != 0) ? headerSize + p->GetSize () : length;
+  record.inclLen = std::min (record.origLen, m_file.GetSnapLen ());
+
+  // only the bytes kept by the snaplen are copied
+  uint8_t *data = GetPcapWriter ()->Reserve (record);
+  if (p == 0)
+    {
+      memcpy (data, buffer, record.inclLen);
+    }
+  else
+    {
+      uint32_t copied = 0;
+      if (header != 0)
+        {
+          Buffer headerBuffer;
+          headerBuffer.AddAtStart (headerSize);
+          header->Serialize (headerBuffer.Begin ());
+          copied = headerBuffer.CopyData (data, record.inclLen);
+        }
+      p->CopyData (data + copied, record.inclLen - copied);
+    }
+  g_pcapWriter->Commit ();
+#endif
+}
+
 bool 
 PcapFileWrapper::Fail (void) const
 {
+  Drain ();
   return m_file.Fail ();
 }
 bool 
 PcapFileWrapper::Eof (void) const
 {
+  Drain ();
   return m_file.Eof ();
 }
 void 
@@ -73,12 +260,14 @@ PcapFileWrapper::Clear (void)
 void
 PcapFileWrapper::Close (void)
 {
+  Drain ();
   m_file.Close ();
 }
 
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
+  m_file.SetBufferSize (m_bufferSize);
   m_file.Open (filename, mode);
 }
 
@@ -103,6 +292,11 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
+  if (IsAsynchronous ())
+    {
+      Queue (t, 0, p, 0, 0);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -113,6 +307,11 @@ PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 void
 PcapFileWrapper::Write (Time t, Header &header, Ptr<const Packet> p)
 {
+  if (IsAsynchronous ())
+    {
+      Queue (t, &header, p, 0, 0);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -123,6 +322,11 @@ PcapFileWrapper::Write (Time t, Header &header, Ptr<const Packet> p)
 void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
+  if (IsAsynchronous ())
+    {
+      Queue (t, 0, 0, buffer, length);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -35,6 +35,11 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When the "Asynchronous" attribute is set, the packets are truncated to
+ * the snaplen and copied to a queue shared by all wrappers: a single
+ * writer thread empties it to the files.  The queue is drained whenever
+ * a file is closed, or its state is queried.
  */
 class PcapFileWrapper : public Object
 {
@@ -195,8 +200,14 @@ public:
   uint32_t GetDataLinkType (void);
 
 private:
+  bool IsAsynchronous (void) const;
+  void Drain (void) const;
+  void Queue (Time t, Header *header, Ptr<const Packet> p, uint8_t const *buffer, uint32_t length);
+
   PcapFile m_file;
   uint32_t m_snapLen;
+  uint32_t m_bufferSize;
+  bool m_asynchronous;
 };
 
 } // namespace ns3
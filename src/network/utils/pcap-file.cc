@@ -24,6 +24,7 @@
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
 #include "ns3/fatal-impl.h"
+#include "ns3/checkpoint.h"
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
@@ -78,6 +79,7 @@ void
 PcapFile::Close (void)
 {
   m_file.close ();
+  Checkpoint::UnregisterOutput (this);
 }
 
 uint32_t
@@ -293,6 +295,11 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   mode |= std::ios::binary;
 
   m_file.open (filename.c_str (), mode);
+  // the files only read, like those of PcapFile::Diff, can be shared
+  if (m_file.is_open () && (mode & std::ios::out))
+    {
+      Checkpoint::RegisterOutput (this, filename);
+    }
   if (mode & std::ios::in)
     {
       // will set the fail bit if file header is invalid.
@@ -300,6 +307,18 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
     }
 }
 
+void
+PcapFile::SetBufferSize (uint32_t size)
+{
+  NS_ASSERT (!m_file.is_open ());
+  if (size == 0)
+    {
+      return;
+    }
+  m_buffer.resize (size);
+  m_file.rdbuf ()->pubsetbuf (&m_buffer[0], size);
+}
+
 void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode)
 {
@@ -350,12 +369,20 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   NS_ASSERT (m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  WritePacketHeader (tsSec, tsUsec, inclLen, totalLen);
+  return inclLen;
+}
+
+void
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t inclLen, uint32_t origLen)
+{
+  NS_ASSERT (m_file.good ());
 
   PcapRecordHeader header;
   header.m_tsSec = tsSec;
   header.m_tsUsec = tsUsec;
   header.m_inclLen = inclLen;
-  header.m_origLen = totalLen;
+  header.m_origLen = origLen;
 
   if (m_swapMode)
     {
@@ -370,7 +397,6 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
   m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
   m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  return inclLen;
 }
 
 void
@@ -380,6 +406,14 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
   m_file.write ((const char *)data, inclLen);
 }
 
+void
+PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t inclLen, uint32_t origLen)
+{
+  NS_ASSERT (inclLen <= origLen && inclLen <= m_fileHeader.m_snapLen);
+  WritePacketHeader (tsSec, tsUsec, inclLen, origLen);
+  m_file.write ((const char *)data, inclLen);
+}
+
 void 
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ptr.h"
 
@@ -78,6 +79,16 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * \param size the size of the buffer used to write to and read
+   *        from the file.  Zero selects the default of the standard
+   *        library.
+   *
+   * Large buffers reduce the number of system calls made when many
+   * small packets are written.  This must be called before Open.
+   */
+  void SetBufferSize (uint32_t size);
+
   /**
    * Close the underlying file.
    */
@@ -127,6 +138,20 @@ public:
    */
   void Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen);
 
+  /**
+   * \brief Write next packet to file
+   *
+   * \param tsSec       Packet timestamp, seconds
+   * \param tsUsec      Packet timestamp, microseconds
+   * \param data        Data buffer, already truncated
+   * \param inclLen     Number of bytes in data
+   * \param origLen     Length of the original packet
+   *
+   * This is used to write a record whose data was captured earlier,
+   * when the snaplen was already applied.
+   */
+  void Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t inclLen, uint32_t origLen);
+
   /**
    * \brief Write next packet to file
    * 
@@ -284,10 +309,12 @@ private:
 
   void WriteFileHeader (void);
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+  void WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t inclLen, uint32_t origLen);
   void ReadAndVerifyFileHeader (void);
 
   std::string    m_filename;
   std::fstream   m_file;
+  std::vector<char> m_buffer;
   PcapFileHeader m_fileHeader;
   bool m_swapMode;
 };
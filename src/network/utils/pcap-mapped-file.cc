@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-mapped-file.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("PcapMappedFile");
+
+namespace ns3 {
+
+namespace {
+const uint32_t MAGIC = 0xa1b2c3d4;
+const uint32_t SWAPPED_MAGIC = 0xd4c3b2a1;
+const uint32_t NS_MAGIC = 0xa1b23cd4;
+const uint32_t NS_SWAPPED_MAGIC = 0xd43cb2a1;
+} // anonymous namespace
+
+PcapMappedFile::PcapMappedFile ()
+  :
+#ifdef HAVE_SYS_MMAN_H
+    m_fd (-1),
+#endif
+    m_fileSize (0),
+    m_offset (0),
+    m_window (0),
+    m_windowStart (0),
+    m_windowSize (0),
+    m_fail (false),
+    m_swapMode (false),
+    m_nanoSeconds (false),
+    m_snapLen (0),
+    m_type (0),
+    m_zone (0)
+{
+}
+
+PcapMappedFile::~PcapMappedFile ()
+{
+  Close ();
+}
+
+void
+PcapMappedFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_fail = true;
+#ifdef HAVE_SYS_MMAN_H
+  m_fd = open (filename.c_str (), O_RDONLY);
+  if (m_fd < 0)
+    {
+      return;
+    }
+  struct stat st;
+  if (fstat (m_fd, &st) != 0)
+    {
+      return;
+    }
+  m_fileSize = st.st_size;
+#else
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  m_file.seekg (0, std::ios::end);
+  if (!m_file.good ())
+    {
+      return;
+    }
+  m_fileSize = m_file.tellg ();
+#endif
+
+  const uint8_t *header = Map (0, FILE_HEADER_SIZE);
+  if (header == 0)
+    {
+      return;
+    }
+  uint32_t magic;
+  memcpy (&magic, header, 4);
+  if (magic != MAGIC && magic != SWAPPED_MAGIC && magic != NS_MAGIC && magic != NS_SWAPPED_MAGIC)
+    {
+      return;
+    }
+  m_swapMode = magic == SWAPPED_MAGIC || magic == NS_SWAPPED_MAGIC;
+  m_nanoSeconds = magic == NS_MAGIC || magic == NS_SWAPPED_MAGIC;
+  m_zone = ReadU32 (header + 8);
+  m_snapLen = ReadU32 (header + 16);
+  m_type = ReadU32 (header + 20);
+  m_offset = FILE_HEADER_SIZE;
+  m_fail = false;
+}
+
+void
+PcapMappedFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  Unmap ();
+#ifdef HAVE_SYS_MMAN_H
+  if (m_fd >= 0)
+    {
+      close (m_fd);
+      m_fd = -1;
+    }
+#else
+  m_file.close ();
+  m_file.clear ();
+#endif
+  m_fileSize = 0;
+  m_offset = 0;
+}
+
+bool
+PcapMappedFile::Fail (void) const
+{
+  return m_fail;
+}
+
+bool
+PcapMappedFile::Next (Record &record)
+{
+  if (m_fail || m_offset >= m_fileSize)
+    {
+      return false;
+    }
+  const uint8_t *header = Map (m_offset, RECORD_HEADER_SIZE);
+  if (header == 0)
+    {
+      m_fail = true;
+      return false;
+    }
+  record.tsSec = ReadU32 (header);
+  record.tsUsec = ReadU32 (header + 4);
+  record.inclLen = ReadU32 (header + 8);
+  record.origLen = ReadU32 (header + 12);
+  // a corrupted length would not fit in the window, or wrap the offset
+  if (record.inclLen > WINDOW_SIZE / 2 - RECORD_HEADER_SIZE)
+    {
+      NS_LOG_WARN ("Record of " << record.inclLen << " bytes at offset " << m_offset);
+      m_fail = true;
+      return false;
+    }
+  // the header is mapped again with the data since the window may move
+  header = Map (m_offset, RECORD_HEADER_SIZE + record.inclLen);
+  if (header == 0)
+    {
+      NS_LOG_WARN ("Truncated record at offset " << m_offset);
+      m_fail = true;
+      return false;
+    }
+  record.data = header + RECORD_HEADER_SIZE;
+  m_offset += (uint64_t)RECORD_HEADER_SIZE + record.inclLen;
+  return true;
+}
+
+void
+PcapMappedFile::Rewind (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_fileSize >= FILE_HEADER_SIZE)
+    {
+      m_offset = FILE_HEADER_SIZE;
+    }
+}
+
+bool
+PcapMappedFile::IsNanoSeconds (void) const
+{
+  return m_nanoSeconds;
+}
+
+bool
+PcapMappedFile::GetSwapMode (void) const
+{
+  return m_swapMode;
+}
+
+uint32_t
+PcapMappedFile::GetSnapLen (void) const
+{
+  return m_snapLen;
+}
+
+uint32_t
+PcapMappedFile::GetDataLinkType (void) const
+{
+  return m_type;
+}
+
+int32_t
+PcapMappedFile::GetTimeZoneOffset (void) const
+{
+  return m_zone;
+}
+
+uint32_t
+PcapMappedFile::ReadU32 (const uint8_t *buffer) const
+{
+  // the fields of the records are not aligned
+  uint32_t v;
+  memcpy (&v, buffer, 4);
+  if (m_swapMode)
+    {
+      v = ((v >> 24) & 0x000000ff) | ((v >> 8) & 0x0000ff00) | ((v << 8) & 0x00ff0000) | ((v << 24) & 0xff000000);
+    }
+  return v;
+}
+
+const uint8_t *
+PcapMappedFile::Map (uint64_t offset, uint32_t size)
+{
+  if (size > WINDOW_SIZE / 2 || offset + size > m_fileSize)
+    {
+      return 0;
+    }
+  if (m_window != 0 && offset >= m_windowStart && offset + size <= m_windowStart + m_windowSize)
+    {
+      return m_window + (offset - m_windowStart);
+    }
+  Unmap ();
+#ifdef HAVE_SYS_MMAN_H
+  // mappings must start on a page boundary
+  uint64_t pageSize = sysconf (_SC_PAGESIZE);
+  uint64_t start = offset - offset % pageSize;
+  uint32_t length = std::min<uint64_t> (WINDOW_SIZE, m_fileSize - start);
+  void *window = mmap (0, length, PROT_READ, MAP_PRIVATE, m_fd, start);
+  if (window == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Could not map " << length << " bytes at offset " << start);
+      return 0;
+    }
+  madvise (window, length, MADV_SEQUENTIAL);
+  m_window = static_cast<const uint8_t *> (window);
+#else
+  uint64_t start = offset;
+  uint32_t length = std::min<uint64_t> (WINDOW_SIZE, m_fileSize - start);
+  m_copy.resize (length);
+  m_file.clear ();
+  m_file.seekg (start);
+  m_file.read (reinterpret_cast<char *> (&m_copy[0]), length);
+  if (!m_file.good ())
+    {
+      return 0;
+    }
+  m_window = &m_copy[0];
+#endif
+  m_windowStart = start;
+  m_windowSize = length;
+  return m_window + (offset - m_windowStart);
+}
+
+void
+PcapMappedFile::Unmap (void)
+{
+  if (m_window == 0)
+    {
+      return;
+    }
+#ifdef HAVE_SYS_MMAN_H
+  munmap (const_cast<uint8_t *> (m_window), m_windowSize);
+#endif
+  m_window = 0;
+  m_windowStart = 0;
+  m_windowSize = 0;
+}
+
+} // namespace ns3
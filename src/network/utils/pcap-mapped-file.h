@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_MAPPED_FILE_H
+#define PCAP_MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/core-config.h"
+
+namespace ns3 {
+
+/**
+ * \brief Read the records of a pcap file without copying them
+ *
+ * The file is mapped in memory by windows of a few tens of megabytes
+ * which follow the records as they are read, so that files much larger
+ * than the memory, or than the address space, can be read sequentially.
+ * The data of a record points directly into the mapping.  Where mmap is
+ * not available, each window is read into a buffer instead.
+ */
+class PcapMappedFile
+{
+public:
+  /**
+   * A record of the file.
+   */
+  struct Record
+  {
+    uint32_t tsSec;           /**< seconds part of timestamp */
+    uint32_t tsUsec;          /**< microseconds part of timestamp (nanoseconds if IsNanoSeconds) */
+    uint32_t inclLen;         /**< number of octets of packet saved in file */
+    uint32_t origLen;         /**< actual length of original packet */
+    const uint8_t *data;      /**< the inclLen octets saved, valid until the next call to Next */
+  };
+
+  PcapMappedFile ();
+  ~PcapMappedFile ();
+
+  /**
+   * \param filename the name of the pcap file to read
+   *
+   * Open the file and read its header.  Fail returns true if the file
+   * could not be opened or is not a pcap file.
+   */
+  void Open (std::string const &filename);
+  /**
+   * Close the file.
+   */
+  void Close (void);
+  /**
+   * \return true if the file could not be opened or is truncated.
+   */
+  bool Fail (void) const;
+
+  /**
+   * \param record [out] the next record of the file
+   * \return false if there is no record left.
+   */
+  bool Next (Record &record);
+  /**
+   * Go back to the first record of the file.
+   */
+  void Rewind (void);
+
+  /**
+   * \return true if the timestamps have nanosecond resolution.
+   */
+  bool IsNanoSeconds (void) const;
+  /**
+   * \return true if the file was written with the other byte order.
+   */
+  bool GetSwapMode (void) const;
+  /**
+   * \return the snaplen field of the pcap global header.
+   */
+  uint32_t GetSnapLen (void) const;
+  /**
+   * \return the data link type field of the pcap global header.
+   */
+  uint32_t GetDataLinkType (void) const;
+  /**
+   * \return the time zone offset field of the pcap global header.
+   */
+  int32_t GetTimeZoneOffset (void) const;
+
+private:
+  enum
+  {
+    FILE_HEADER_SIZE = 24,
+    RECORD_HEADER_SIZE = 16,
+    WINDOW_SIZE = 64 * 1024 * 1024
+  };
+  PcapMappedFile (const PcapMappedFile &o);
+  PcapMappedFile &operator = (const PcapMappedFile &o);
+
+  uint32_t ReadU32 (const uint8_t *buffer) const;
+  /**
+   * \return a pointer to the size bytes at offset in the file, or
+   *         zero if the file is too short.
+   */
+  const uint8_t *Map (uint64_t offset, uint32_t size);
+  void Unmap (void);
+
+#ifdef HAVE_SYS_MMAN_H
+  int m_fd;
+#else
+  std::ifstream m_file;
+  std::vector<uint8_t> m_copy;
+#endif
+  uint64_t m_fileSize;
+  // offset in the file of the next record
+  uint64_t m_offset;
+  const uint8_t *m_window;
+  uint64_t m_windowStart;
+  uint32_t m_windowSize;
+  bool m_fail;
+  bool m_swapMode;
+  bool m_nanoSeconds;
+  uint32_t m_snapLen;
+  uint32_t m_type;
+  int32_t m_zone;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_MAPPED_FILE_H */
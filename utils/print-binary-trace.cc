@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/binary-trace.h"
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+/*
+ * Print a trace file written through AsciiTraceHelper::CreateBinaryFileStream
+ * as columns, or with --ascii in the format of the ascii traces.
+ */
+int main (int argc, char *argv[])
+{
+  bool ascii = argc == 3 && std::string (argv[1]) == "--ascii";
+  if (argc != 2 && !ascii)
+    {
+      std::cerr << "usage: " << argv[0] << " [--ascii] FILE" << std::endl;
+      return 1;
+    }
+  if (!ascii)
+    {
+      std::cout << "# type time node device uid size flow" << std::endl;
+    }
+  BinaryTraceDecode (argv[argc - 1], std::cout, ascii);
+  return 0;
+}